@@ -0,0 +1,151 @@
+#include "gtkscintilla.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// scroll: frame times while scrolling a large document one line per frame and eleven lines per
+// frame, lines still in view keep their recorded render nodes
+// wrap: time to wrap every line of a long lined document with empty position caches, on one
+// layout thread and on all of them, with pooled measuring layouts and with one per measurement
+
+#define SCROLL_LINES 1000000
+#define SCROLL_FRAMES 600
+#define WRAP_LINES 200000
+#define MEASURING_POOL 32
+
+GtkApplication* app = NULL;
+GtkWidget* sci;
+int phase;
+int frame;
+guint wrapThreads[4] = { 1, 1, 1, 1 };
+guint wrapPools[4] = { MEASURING_POOL, MEASURING_POOL, 0, 0 };
+gint64 wrapStart;
+
+static char* makeText(int lines, int repeat)
+{
+	GString* text = g_string_sized_new((gsize)lines * 64 * repeat);
+	for (int i = 0; i < lines; i++)
+	{
+		for (int r = 0; r < repeat; r++)
+			g_string_append_printf(text, "{ \"line\": %d, \"name\": \"item %d\", \"value\": [%d, %d, %d] }, ", i, i + r, i, i * 2, i * 3);
+		g_string_append_c(text, '\n');
+	}
+	return g_string_free(text, FALSE);
+}
+
+static void report(const char* name)
+{
+	GtkScintillaFrameStats stats;
+	gtk_scintilla_get_frame_stats(GTK_SCINTILLA(sci), &stats);
+	if (stats.frames == 0)
+		return;
+	printf("%-22s %6" G_GUINT64_FORMAT " frames %6" G_GUINT64_FORMAT " scrolled %8" G_GUINT64_FORMAT " lines  avg %8.1f us  max %8" G_GINT64_FORMAT " us\n",
+		name, stats.frames, stats.scrolledFrames, stats.recordedLines, (double)stats.totalTime / stats.frames, stats.maxTime);
+
+	GtkScintillaGlyphCacheStats glyphs;
+	gtk_scintilla_get_glyph_cache_stats(&glyphs);
+	guint64 drawn = glyphs.hits + glyphs.misses;
+	printf("%-22s %6.1f%% glyph cache hits %6" G_GUINT64_FORMAT " entries %8" G_GUINT64_FORMAT " bytes\n",
+		"", drawn ? 100.0 * glyphs.hits / drawn : 0.0, glyphs.entries, glyphs.size);
+}
+
+static gboolean scrollTick(GtkWidget* widget, GdkFrameClock* clock, gpointer data)
+{
+	static const int steps[] = { 1, 11 };
+	static const char* names[] = { "scroll 1 line/frame", "scroll 11 lines/frame" };
+
+	// lines styled while scrolling are repainted completely, measure a fully styled document
+	if (gtk_scintilla_get_restyle_progress(GTK_SCINTILLA(sci)) < 1.0)
+		return G_SOURCE_CONTINUE;
+	if (frame == 0)
+	{
+		gtk_scintilla_reset_frame_stats(GTK_SCINTILLA(sci));
+		gtk_scintilla_reset_glyph_cache_stats();
+	}
+	gtk_scintilla_scroll_to_line(GTK_SCINTILLA(sci), steps[phase], 0);
+	if (++frame < SCROLL_FRAMES)
+		return G_SOURCE_CONTINUE;
+
+	report(names[phase]);
+	frame = 0;
+	if (++phase < (int)G_N_ELEMENTS(steps))
+		return G_SOURCE_CONTINUE;
+
+	g_application_quit(G_APPLICATION(app));
+	return G_SOURCE_REMOVE;
+}
+
+static void startWrap(void);
+
+static gboolean wrapDone(gpointer data)
+{
+	gint64 elapsed = g_get_monotonic_time() - wrapStart;
+	printf("cold wrap %2u thread%s %-12s %8.1f ms\n", wrapThreads[phase], wrapThreads[phase] == 1 ? " " : "s",
+		wrapPools[phase] ? "pooled" : "per call", elapsed / 1000.0);
+	if (++phase < (int)G_N_ELEMENTS(wrapThreads))
+		startWrap();
+	else
+		g_application_quit(G_APPLICATION(app));
+	return G_SOURCE_REMOVE;
+}
+
+static void startWrap(void)
+{
+	// setting the position cache size empties it, lines are then wrapped by the editor's idle
+	// work and the lower priority idle only runs once that has finished
+	gtk_scintilla_set_wrap_mode(GTK_SCINTILLA(sci), GTK_WRAP_NONE);
+	gtk_scintilla_set_layout_threads(GTK_SCINTILLA(sci), wrapThreads[phase]);
+	gtk_scintilla_set_measuring_pool_size(wrapPools[phase]);
+	gtk_scintilla_set_position_cache(GTK_SCINTILLA(sci), gtk_scintilla_get_position_cache(GTK_SCINTILLA(sci)));
+	wrapStart = g_get_monotonic_time();
+	gtk_scintilla_set_wrap_mode(GTK_SCINTILLA(sci), GTK_WRAP_WORD);
+	g_idle_add_full(G_PRIORITY_LOW, wrapDone, NULL, NULL);
+}
+
+static gboolean wrapTick(GtkWidget* widget, GdkFrameClock* clock, gpointer data)
+{
+	if (gtk_scintilla_get_restyle_progress(GTK_SCINTILLA(sci)) < 1.0)
+		return G_SOURCE_CONTINUE;
+	wrapThreads[1] = wrapThreads[3] = g_get_num_processors();
+	startWrap();
+	return G_SOURCE_REMOVE;
+}
+
+static void onActive(GApplication* application, gpointer mode)
+{
+	GtkWidget* win = gtk_application_window_new(app);
+	gtk_window_set_title(GTK_WINDOW(win), "Gtk4Scintilla Benchmark");
+
+	sci = gtk_scintilla_new();
+	gtk_widget_set_hexpand(sci, true);
+	gtk_widget_set_vexpand(sci, true);
+	gtk_scintilla_set_style(GTK_SCINTILLA(sci), "vscode");
+	gtk_scintilla_set_language(GTK_SCINTILLA(sci), "json");
+	gtk_scintilla_set_line_number(GTK_SCINTILLA(sci), true);
+
+	gboolean wrap = g_strcmp0(mode, "wrap") == 0;
+	char* text = wrap ? makeText(WRAP_LINES, 4) : makeText(SCROLL_LINES, 1);
+	gtk_scintilla_set_text(GTK_SCINTILLA(sci), text);
+	g_free(text);
+	gtk_widget_add_tick_callback(sci, wrap ? wrapTick : scrollTick, NULL, NULL);
+
+	gtk_window_set_child(GTK_WINDOW(win), sci);
+	gtk_window_set_default_size(GTK_WINDOW(win), 800, 600);
+	gtk_window_present(GTK_WINDOW(win));
+}
+
+int main(int argc, char* argv[])
+{
+	const char* mode = argc > 1 ? argv[1] : "scroll";
+	if (g_strcmp0(mode, "scroll") != 0 && g_strcmp0(mode, "wrap") != 0)
+	{
+		fprintf(stderr, "usage: %s [scroll|wrap]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	gtk_init();
+	app = gtk_application_new("com.github.xuges.gtk4scintilla.bench", G_APPLICATION_NON_UNIQUE);
+	g_signal_connect(app, "activate", G_CALLBACK(onActive), (gpointer)mode);
+	g_application_run(G_APPLICATION(app), 0, NULL);
+	return 0;
+}
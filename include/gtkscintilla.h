@@ -52,10 +52,64 @@ struct _GtkScintillaClass
 
 	// signals
 	void(*text_changed)(GtkScintilla* self);
+	void(*changes)(GtkScintilla* self, GArray* changes, gint64 firstLine, gint64 lastLine);
 };
 
+// walks the document text in at most two contiguous chunks, invalidated by any modification
+typedef struct _GtkScintillaChunkIter
+{
+	gintptr pos;
+	gintptr end;
+	gintptr gap;
+} GtkScintillaChunkIter;
+
+// match range filled by gtk_scintilla_find_all
+typedef struct _GtkScintillaRange
+{
+	gintptr start;
+	gintptr end;
+} GtkScintillaRange;
+
+// one span of the changes signal: inserted bytes replaced deleted bytes at position, spans apply in order
+typedef struct _GtkScintillaChange
+{
+	gintptr position;
+	gintptr inserted;
+	gintptr deleted;
+} GtkScintillaChange;
+
+// matches of one search kept up to date through edits, see gtk_scintilla_search_new
+typedef struct _GtkScintillaSearch GtkScintillaSearch;
+
+// receives the next batch of gtk_scintilla_search_async matches in document order, positioned in
+// the text as it was when the search started
+typedef void (*GtkScintillaSearchFoundCallback)(GtkScintilla* self, GArray* ranges, gpointer userData);
+
+// text area drawing since the last reset, times in microseconds, scrolled frames only painted the lines
+// scrolled into view and reused the rest, recorded lines counts the display lines painted again
+typedef struct _GtkScintillaFrameStats
+{
+	guint64 frames;
+	guint64 scrolledFrames;
+	gint64 totalTime;
+	gint64 maxTime;
+	guint64 recordedLines;
+} GtkScintillaFrameStats;
+
+// shaped text kept for drawing by all widgets since the last reset, size and budget in approximate bytes
+typedef struct _GtkScintillaGlyphCacheStats
+{
+	guint64 hits;
+	guint64 misses;
+	guint64 entries;
+	guint64 size;
+	guint64 budget;
+} GtkScintillaGlyphCacheStats;
+
 GSCI_EXTERN GType gtk_scintilla_get_type(void);
 GSCI_EXTERN GtkWidget* gtk_scintilla_new(void);
+// shares the document of other, language and read-only state belong to the document and so to every view
+GSCI_EXTERN GtkWidget* gtk_scintilla_new_view_of(GtkScintilla* other);
 GSCI_EXTERN gboolean gtk_scintilla_get_dark(GtkScintilla* self);
 GSCI_EXTERN void gtk_scintilla_set_dark(GtkScintilla* self, gboolean v);
 GSCI_EXTERN const char* gtk_scintilla_get_style(GtkScintilla* self);
@@ -66,7 +120,10 @@ GSCI_EXTERN gboolean gtk_scintilla_get_editable(GtkScintilla* self);
 GSCI_EXTERN void gtk_scintilla_set_editable(GtkScintilla* self, gboolean enb);
 GSCI_EXTERN gboolean gtk_scintilla_get_line_number(GtkScintilla* self);
 GSCI_EXTERN void gtk_scintilla_set_line_number(GtkScintilla* self, gboolean enb);
+GSCI_EXTERN guint gtk_scintilla_get_line_number_max_lines(GtkScintilla* self);
+GSCI_EXTERN void gtk_scintilla_set_line_number_max_lines(GtkScintilla* self, guint lines);
 GSCI_EXTERN guint gtk_scintilla_get_lines(GtkScintilla* self);
+GSCI_EXTERN gdouble gtk_scintilla_get_restyle_progress(GtkScintilla* self);
 GSCI_EXTERN gboolean gtk_scintilla_get_auto_indent(GtkScintilla* self);
 GSCI_EXTERN void gtk_scintilla_set_auto_indent(GtkScintilla* self, gboolean enb);
 GSCI_EXTERN gboolean gtk_scintilla_get_indent_guides(GtkScintilla* self);
@@ -77,8 +134,36 @@ GSCI_EXTERN GtkWrapMode gtk_scintilla_get_wrap_mode(GtkScintilla* self);
 GSCI_EXTERN void gtk_scintilla_set_wrap_mode(GtkScintilla* self, GtkWrapMode mode);
 GSCI_EXTERN guint gtk_scintilla_get_tab_width(GtkScintilla* self);
 GSCI_EXTERN void gtk_scintilla_set_tab_width(GtkScintilla* self, guint width);
+GSCI_EXTERN guint gtk_scintilla_get_mod_event_mask(GtkScintilla* self);
+GSCI_EXTERN void gtk_scintilla_set_mod_event_mask(GtkScintilla* self, guint mask);
+GSCI_EXTERN gboolean gtk_scintilla_get_log_mode(GtkScintilla* self);
+GSCI_EXTERN void gtk_scintilla_set_log_mode(GtkScintilla* self, gboolean enb);
+GSCI_EXTERN guint gtk_scintilla_get_log_max_lines(GtkScintilla* self);
+GSCI_EXTERN void gtk_scintilla_set_log_max_lines(GtkScintilla* self, guint lines);
 GSCI_EXTERN void gtk_scintilla_set_text(GtkScintilla* self, const char* text);
 GSCI_EXTERN void gtk_scintilla_append_text(GtkScintilla* self, const char* text, gint64 length);
+GSCI_EXTERN gboolean gtk_scintilla_append_text_threadsafe(GtkScintilla* self, const char* text, gssize length);
+GSCI_EXTERN guint64 gtk_scintilla_get_append_budget(GtkScintilla* self);
+GSCI_EXTERN void gtk_scintilla_set_append_budget(GtkScintilla* self, guint64 budget);
+GSCI_EXTERN guint gtk_scintilla_get_layout_threads(GtkScintilla* self);
+GSCI_EXTERN void gtk_scintilla_set_layout_threads(GtkScintilla* self, guint threads);
+GSCI_EXTERN guint gtk_scintilla_get_idle_styling(GtkScintilla* self);
+GSCI_EXTERN void gtk_scintilla_set_idle_styling(GtkScintilla* self, guint idle);
+GSCI_EXTERN guint gtk_scintilla_get_layout_cache(GtkScintilla* self);
+GSCI_EXTERN void gtk_scintilla_set_layout_cache(GtkScintilla* self, guint cache);
+GSCI_EXTERN guint gtk_scintilla_get_position_cache(GtkScintilla* self);
+GSCI_EXTERN void gtk_scintilla_set_position_cache(GtkScintilla* self, guint size);
+// "auto" keeps the four settings above tuned to the document, "default" leaves them as set
+GSCI_EXTERN const char* gtk_scintilla_get_performance_profile(GtkScintilla* self);
+GSCI_EXTERN void gtk_scintilla_set_performance_profile(GtkScintilla* self, const char* profile);
+GSCI_EXTERN void gtk_scintilla_get_frame_stats(GtkScintilla* self, GtkScintillaFrameStats* stats);
+GSCI_EXTERN void gtk_scintilla_reset_frame_stats(GtkScintilla* self);
+GSCI_EXTERN void gtk_scintilla_get_glyph_cache_stats(GtkScintillaGlyphCacheStats* stats);
+GSCI_EXTERN void gtk_scintilla_reset_glyph_cache_stats(void);
+// 0 shapes text every time it is drawn
+GSCI_EXTERN void gtk_scintilla_set_glyph_cache_budget(guint64 budget);
+// Pango layouts kept for measuring text by all widgets, 0 creates one for each measurement
+GSCI_EXTERN void gtk_scintilla_set_measuring_pool_size(guint size);
 GSCI_EXTERN guint64 gtk_scintilla_get_text_length(GtkScintilla* self);
 GSCI_EXTERN guint64 gtk_scintilla_get_text(GtkScintilla* self, char* buf, guint64 length);
 GSCI_EXTERN void gtk_scintilla_clear_text(GtkScintilla* self);
@@ -89,6 +174,33 @@ GSCI_EXTERN void gtk_scintilla_scroll_to_pos(GtkScintilla* self, gintptr pos);
 GSCI_EXTERN void gtk_scintilla_reset_search(GtkScintilla* self);
 GSCI_EXTERN gintptr gtk_scintilla_search_prev(GtkScintilla* self, const char* text, gintptr length, gboolean matchCase, gboolean wholeWord);
 GSCI_EXTERN gintptr gtk_scintilla_search_next(GtkScintilla* self, const char* text, gintptr length, gboolean matchCase, gboolean wholeWord);
+GSCI_EXTERN GtkScintillaSearch* gtk_scintilla_search_new(GtkScintilla* self, const char* text, gintptr length, gboolean matchCase, gboolean wholeWord);
+GSCI_EXTERN void gtk_scintilla_search_free(GtkScintillaSearch* search);
+GSCI_EXTERN gboolean gtk_scintilla_search_next_match(GtkScintillaSearch* search, GtkScintillaRange* match);
+GSCI_EXTERN gboolean gtk_scintilla_search_prev_match(GtkScintillaSearch* search, GtkScintillaRange* match);
+GSCI_EXTERN void gtk_scintilla_search_reset(GtkScintillaSearch* search);
+GSCI_EXTERN guint gtk_scintilla_search_get_count(GtkScintillaSearch* search);
+GSCI_EXTERN gint gtk_scintilla_search_get_index(GtkScintillaSearch* search);
+GSCI_EXTERN gboolean gtk_scintilla_search_is_complete(GtkScintillaSearch* search);
+GSCI_EXTERN gintptr gtk_scintilla_regex_find(GtkScintilla* self, const char* pattern, gintptr length, gboolean matchCase, gintptr start, gintptr end, gintptr* matchEnd);
+GSCI_EXTERN guint gtk_scintilla_find_all(GtkScintilla* self, const char* text, gintptr length, gboolean matchCase, gboolean wholeWord, GArray* ranges);
+GSCI_EXTERN void gtk_scintilla_highlight_ranges(GtkScintilla* self, GArray* ranges);
+GSCI_EXTERN void gtk_scintilla_highlight_terms(GtkScintilla* self, const char* const* terms, const int* indicators, guint count, gboolean matchCase);
+GSCI_EXTERN void gtk_scintilla_load_file_async(GtkScintilla* self, GFile* file, GCancellable* cancellable, GFileProgressCallback progress, gpointer progressData, GAsyncReadyCallback callback, gpointer userData);
+GSCI_EXTERN gboolean gtk_scintilla_load_file_finish(GtkScintilla* self, GAsyncResult* result, GError** error);
+GSCI_EXTERN gboolean gtk_scintilla_open_mapped(GtkScintilla* self, const char* path, GError** error);
+GSCI_EXTERN GBytes* gtk_scintilla_get_range_bytes(GtkScintilla* self, gintptr start, gintptr end);
+GSCI_EXTERN void gtk_scintilla_chunk_iter_init(GtkScintilla* self, GtkScintillaChunkIter* iter, gintptr start, gintptr end);
+GSCI_EXTERN gboolean gtk_scintilla_chunk_iter_next(GtkScintilla* self, GtkScintillaChunkIter* iter, const char** data, gsize* length);
+GSCI_EXTERN void gtk_scintilla_save_async(GtkScintilla* self, GFile* file, const char* charset, const char* eol, GCancellable* cancellable, GAsyncReadyCallback callback, gpointer userData);
+GSCI_EXTERN gboolean gtk_scintilla_save_finish(GtkScintilla* self, GAsyncResult* result, GError** error);
+GSCI_EXTERN void gtk_scintilla_search_async(GtkScintilla* self, const char* text, gintptr length, gboolean matchCase, gboolean wholeWord, GCancellable* cancellable, GtkScintillaSearchFoundCallback found, GFileProgressCallback progress, gpointer progressData, GAsyncReadyCallback callback, gpointer userData);
+GSCI_EXTERN gssize gtk_scintilla_search_finish(GtkScintilla* self, GAsyncResult* result, GError** error);
+GSCI_EXTERN gboolean gtk_scintilla_get_search_index(GtkScintilla* self);
+GSCI_EXTERN void gtk_scintilla_set_search_index(GtkScintilla* self, gboolean enb);
+GSCI_EXTERN guint64 gtk_scintilla_get_search_index_budget(GtkScintilla* self);
+GSCI_EXTERN void gtk_scintilla_set_search_index_budget(GtkScintilla* self, guint64 budget);
+GSCI_EXTERN guint64 gtk_scintilla_get_search_index_memory(GtkScintilla* self);
 
 G_BEGIN_DECLS
 
@@ -10,6 +10,7 @@ import "C"
 
 import (
 	"runtime"
+	"time"
 	"unsafe"
 
 	"github.com/diamondburned/gotk4/pkg/core/gextras"
@@ -44,6 +45,13 @@ func NewScintilla() *Scintilla {
 	return wrapScintilla(coreglib.Take(unsafe.Pointer(p)))
 }
 
+// NewViewOf creates another view sharing the document of other
+func NewViewOf(other *Scintilla) *Scintilla {
+	p := C.gtk_scintilla_new_view_of(other.self())
+	runtime.KeepAlive(other)
+	return wrapScintilla(coreglib.Take(unsafe.Pointer(p)))
+}
+
 func (s *Scintilla) Style() string {
 	ret := C.gtk_scintilla_get_style(s.self())
 	runtime.KeepAlive(s)
@@ -104,6 +112,18 @@ func (s *Scintilla) SetLineNumber(v bool) {
 	runtime.KeepAlive(s)
 }
 
+// LineNumberMaxLines is the line count the line number margin is sized for, 0 fits it to the text
+func (s *Scintilla) LineNumberMaxLines() uint {
+	ret := C.gtk_scintilla_get_line_number_max_lines(s.self())
+	runtime.KeepAlive(s)
+	return uint(ret)
+}
+
+func (s *Scintilla) SetLineNumberMaxLines(lines uint) {
+	C.gtk_scintilla_set_line_number_max_lines(s.self(), C.guint(lines))
+	runtime.KeepAlive(s)
+}
+
 func (s *Scintilla) AutoIndent() bool {
 	ret := C.gtk_scintilla_get_auto_indent(s.self())
 	runtime.KeepAlive(s)
@@ -148,6 +168,37 @@ func (s *Scintilla) SetTabWidth(width uint) {
 	runtime.KeepAlive(s)
 }
 
+// SearchIndex reports whether searches are narrowed by a trigram index of the document
+func (s *Scintilla) SearchIndex() bool {
+	ret := C.gtk_scintilla_get_search_index(s.self())
+	runtime.KeepAlive(s)
+	return ret != 0
+}
+
+// SetSearchIndex builds the index in the background from a snapshot, the document stays editable
+func (s *Scintilla) SetSearchIndex(v bool) {
+	C.gtk_scintilla_set_search_index(s.self(), s.boolean(v))
+	runtime.KeepAlive(s)
+}
+
+func (s *Scintilla) SearchIndexBudget() uint64 {
+	ret := C.gtk_scintilla_get_search_index_budget(s.self())
+	runtime.KeepAlive(s)
+	return uint64(ret)
+}
+
+// SetSearchIndexBudget limits the index memory in bytes, 0 sizes it from the text
+func (s *Scintilla) SetSearchIndexBudget(budget uint64) {
+	C.gtk_scintilla_set_search_index_budget(s.self(), C.guint64(budget))
+	runtime.KeepAlive(s)
+}
+
+func (s *Scintilla) SearchIndexMemory() uint64 {
+	ret := C.gtk_scintilla_get_search_index_memory(s.self())
+	runtime.KeepAlive(s)
+	return uint64(ret)
+}
+
 func (s *Scintilla) WrapMode() gtk.WrapMode {
 	ret := C.gtk_scintilla_get_wrap_mode(s.self())
 	runtime.KeepAlive(s)
@@ -159,17 +210,67 @@ func (s *Scintilla) SetWrapMode(mode gtk.WrapMode) {
 	runtime.KeepAlive(s)
 }
 
+// ModEventMask is the set of SC_MOD_* events sent with sci-notify
+func (s *Scintilla) ModEventMask() uint {
+	ret := C.gtk_scintilla_get_mod_event_mask(s.self())
+	runtime.KeepAlive(s)
+	return uint(ret)
+}
+
+func (s *Scintilla) SetModEventMask(mask uint) {
+	C.gtk_scintilla_set_mod_event_mask(s.self(), C.guint(mask))
+	runtime.KeepAlive(s)
+}
+
+// LogMode batches AppendText per frame without undo or change history
+func (s *Scintilla) LogMode() bool {
+	ret := C.gtk_scintilla_get_log_mode(s.self())
+	runtime.KeepAlive(s)
+	return ret != 0
+}
+
+func (s *Scintilla) SetLogMode(v bool) {
+	C.gtk_scintilla_set_log_mode(s.self(), s.boolean(v))
+	runtime.KeepAlive(s)
+}
+
+// LogMaxLines is the number of lines kept in log mode, 0 keeps everything
+func (s *Scintilla) LogMaxLines() uint {
+	ret := C.gtk_scintilla_get_log_max_lines(s.self())
+	runtime.KeepAlive(s)
+	return uint(ret)
+}
+
+func (s *Scintilla) SetLogMaxLines(lines uint) {
+	C.gtk_scintilla_set_log_max_lines(s.self(), C.guint(lines))
+	runtime.KeepAlive(s)
+}
+
 func (s *Scintilla) Lines() uint {
 	ret := C.gtk_scintilla_get_lines(s.self())
 	runtime.KeepAlive(s)
 	return uint(ret)
 }
 
+// RestyleProgress is the share of the document lexed since the last language change, 1 when done
+func (s *Scintilla) RestyleProgress() float64 {
+	ret := C.gtk_scintilla_get_restyle_progress(s.self())
+	runtime.KeepAlive(s)
+	return float64(ret)
+}
+
 func (s *Scintilla) Text() string {
 	length := C.gtk_scintilla_get_text_length(s.self())
-	buf := make([]byte, int(length))
-	C.gtk_scintilla_get_text(s.self(), (*C.char)(unsafe.Pointer(unsafe.SliceData(buf))), length)
-	runtime.KeepAlive(buf)
+	buf := make([]byte, 0, int(length))
+
+	// copy straight from the gap buffer halves
+	var iter C.GtkScintillaChunkIter
+	var data *C.char
+	var n C.gsize
+	C.gtk_scintilla_chunk_iter_init(s.self(), &iter, 0, -1)
+	for C.gtk_scintilla_chunk_iter_next(s.self(), &iter, &data, &n) != 0 {
+		buf = append(buf, unsafe.Slice((*byte)(unsafe.Pointer(data)), int(n))...)
+	}
 	runtime.KeepAlive(s)
 	return unsafe.String(unsafe.SliceData(buf), len(buf))
 }
@@ -206,6 +307,168 @@ func (s *Scintilla) AppendText(text string) {
 	}
 }
 
+// AppendTextThreadsafe may be called from any goroutine, the text is appended by the
+// main loop in one batch with everything queued meanwhile. It blocks while more than
+// AppendBudget bytes are queued and returns false once the widget is disposed.
+func (s *Scintilla) AppendTextThreadsafe(text string) bool {
+	if len(text) == 0 {
+		return true
+	}
+	arg := unsafe.StringData(text)
+	ret := C.gtk_scintilla_append_text_threadsafe(s.self(), (*C.char)(unsafe.Pointer(arg)), C.gssize(len(text)))
+	runtime.KeepAlive(text)
+	runtime.KeepAlive(s)
+	return ret != 0
+}
+
+func (s *Scintilla) AppendBudget() uint64 {
+	ret := C.gtk_scintilla_get_append_budget(s.self())
+	runtime.KeepAlive(s)
+	return uint64(ret)
+}
+
+func (s *Scintilla) SetAppendBudget(budget uint64) {
+	C.gtk_scintilla_set_append_budget(s.self(), C.guint64(budget))
+	runtime.KeepAlive(s)
+}
+
+// LayoutThreads is the number of threads laying out long lines
+func (s *Scintilla) LayoutThreads() uint {
+	ret := C.gtk_scintilla_get_layout_threads(s.self())
+	runtime.KeepAlive(s)
+	return uint(ret)
+}
+
+func (s *Scintilla) SetLayoutThreads(v uint) {
+	C.gtk_scintilla_set_layout_threads(s.self(), C.guint(v))
+	runtime.KeepAlive(s)
+}
+
+// IdleStyling is one of the SC_IDLESTYLING levels
+func (s *Scintilla) IdleStyling() uint {
+	ret := C.gtk_scintilla_get_idle_styling(s.self())
+	runtime.KeepAlive(s)
+	return uint(ret)
+}
+
+func (s *Scintilla) SetIdleStyling(v uint) {
+	C.gtk_scintilla_set_idle_styling(s.self(), C.guint(v))
+	runtime.KeepAlive(s)
+}
+
+// LayoutCache is one of the SC_CACHE levels
+func (s *Scintilla) LayoutCache() uint {
+	ret := C.gtk_scintilla_get_layout_cache(s.self())
+	runtime.KeepAlive(s)
+	return uint(ret)
+}
+
+func (s *Scintilla) SetLayoutCache(v uint) {
+	C.gtk_scintilla_set_layout_cache(s.self(), C.guint(v))
+	runtime.KeepAlive(s)
+}
+
+// PositionCache is the number of measured text segments kept
+func (s *Scintilla) PositionCache() uint {
+	ret := C.gtk_scintilla_get_position_cache(s.self())
+	runtime.KeepAlive(s)
+	return uint(ret)
+}
+
+func (s *Scintilla) SetPositionCache(v uint) {
+	C.gtk_scintilla_set_position_cache(s.self(), C.guint(v))
+	runtime.KeepAlive(s)
+}
+
+// PerformanceProfile is "auto" while the settings above follow the document, otherwise "default"
+func (s *Scintilla) PerformanceProfile() string {
+	ret := C.gtk_scintilla_get_performance_profile(s.self())
+	runtime.KeepAlive(s)
+	return C.GoString(ret)
+}
+
+func (s *Scintilla) SetPerformanceProfile(profile string) {
+	arg := C.CString(profile)
+	defer C.free(unsafe.Pointer(arg))
+	C.gtk_scintilla_set_performance_profile(s.self(), arg)
+	runtime.KeepAlive(profile)
+	runtime.KeepAlive(s)
+}
+
+// FrameStats describes text area drawing since the last reset, ScrolledFrames only painted
+// the lines scrolled into view and RecordedLines counts the display lines painted again
+type FrameStats struct {
+	Frames         uint64
+	ScrolledFrames uint64
+	TotalTime      time.Duration
+	MaxTime        time.Duration
+	RecordedLines  uint64
+}
+
+func (s *Scintilla) FrameStats() FrameStats {
+	var stats C.GtkScintillaFrameStats
+	C.gtk_scintilla_get_frame_stats(s.self(), &stats)
+	runtime.KeepAlive(s)
+	return FrameStats{
+		Frames:         uint64(stats.frames),
+		ScrolledFrames: uint64(stats.scrolledFrames),
+		TotalTime:      time.Duration(stats.totalTime) * time.Microsecond,
+		MaxTime:        time.Duration(stats.maxTime) * time.Microsecond,
+		RecordedLines:  uint64(stats.recordedLines),
+	}
+}
+
+func (s *Scintilla) ResetFrameStats() {
+	C.gtk_scintilla_reset_frame_stats(s.self())
+	runtime.KeepAlive(s)
+}
+
+// GlyphCacheStats describes the shaped text kept for drawing by all widgets since the last
+// reset, Size and Budget are approximate bytes
+type GlyphCacheStats struct {
+	Hits    uint64
+	Misses  uint64
+	Entries uint64
+	Size    uint64
+	Budget  uint64
+}
+
+// HitRate is the fraction of text drawn without shaping it again
+func (g GlyphCacheStats) HitRate() float64 {
+	if g.Hits+g.Misses == 0 {
+		return 0
+	}
+	return float64(g.Hits) / float64(g.Hits+g.Misses)
+}
+
+func GetGlyphCacheStats() GlyphCacheStats {
+	var stats C.GtkScintillaGlyphCacheStats
+	C.gtk_scintilla_get_glyph_cache_stats(&stats)
+	return GlyphCacheStats{
+		Hits:    uint64(stats.hits),
+		Misses:  uint64(stats.misses),
+		Entries: uint64(stats.entries),
+		Size:    uint64(stats.size),
+		Budget:  uint64(stats.budget),
+	}
+}
+
+func ResetGlyphCacheStats() {
+	C.gtk_scintilla_reset_glyph_cache_stats()
+}
+
+// SetGlyphCacheBudget sets the approximate bytes of shaped text kept, 0 shapes text every time
+// it is drawn
+func SetGlyphCacheBudget(budget uint64) {
+	C.gtk_scintilla_set_glyph_cache_budget(C.guint64(budget))
+}
+
+// SetMeasuringPoolSize sets the Pango layouts kept for measuring text, 0 creates one for each
+// measurement
+func SetMeasuringPoolSize(size uint) {
+	C.gtk_scintilla_set_measuring_pool_size(C.guint(size))
+}
+
 func (s *Scintilla) ClearText() {
 	C.gtk_scintilla_clear_text(s.self())
 	runtime.KeepAlive(s)
@@ -252,6 +515,139 @@ func (s *Scintilla) SearchNext(text string, matchCase, wholeWord bool) int {
 	return int(pos)
 }
 
+// Search keeps the matches of one text up to date through edits, call Free when done
+type Search struct {
+	native *C.GtkScintillaSearch
+	owner  *Scintilla
+}
+
+// NewSearch scans the visible lines now and the rest of the document when idle, nil for an empty text
+func (s *Scintilla) NewSearch(text string, matchCase, wholeWord bool) *Search {
+	if len(text) == 0 {
+		return nil
+	}
+	str := C.CString(text)
+	defer C.free(unsafe.Pointer(str))
+	native := C.gtk_scintilla_search_new(s.self(), str, C.gintptr(len(text)), s.boolean(matchCase), s.boolean(wholeWord))
+	runtime.KeepAlive(s)
+	return &Search{native, s}
+}
+
+func (search *Search) Free() {
+	C.gtk_scintilla_search_free(search.native)
+	search.native = nil
+}
+
+func (search *Search) NextMatch() (Range, bool) {
+	var match C.GtkScintillaRange
+	if C.gtk_scintilla_search_next_match(search.native, &match) == 0 {
+		return Range{}, false
+	}
+	runtime.KeepAlive(search.owner)
+	return Range{int(match.start), int(match.end)}, true
+}
+
+func (search *Search) PrevMatch() (Range, bool) {
+	var match C.GtkScintillaRange
+	if C.gtk_scintilla_search_prev_match(search.native, &match) == 0 {
+		return Range{}, false
+	}
+	runtime.KeepAlive(search.owner)
+	return Range{int(match.start), int(match.end)}, true
+}
+
+func (search *Search) Reset() {
+	C.gtk_scintilla_search_reset(search.native)
+}
+
+// Count is the number of matches found so far, all of them once Complete
+func (search *Search) Count() int {
+	return int(C.gtk_scintilla_search_get_count(search.native))
+}
+
+// Index of the current match, -1 when there is none
+func (search *Search) Index() int {
+	return int(C.gtk_scintilla_search_get_index(search.native))
+}
+
+func (search *Search) Complete() bool {
+	return C.gtk_scintilla_search_is_complete(search.native) != 0
+}
+
+// RegexFind searches [start, end) with the linear-time regex engine, backwards when start > end
+func (s *Scintilla) RegexFind(pattern string, matchCase bool, start, end int) (Range, bool) {
+	str := C.CString(pattern)
+	defer C.free(unsafe.Pointer(str))
+	var matchEnd C.gintptr
+	pos := C.gtk_scintilla_regex_find(s.self(), str, C.gintptr(len(pattern)), s.boolean(matchCase), C.gintptr(start), C.gintptr(end), &matchEnd)
+	runtime.KeepAlive(s)
+	if pos < 0 {
+		return Range{}, false
+	}
+	return Range{int(pos), int(matchEnd)}, true
+}
+
+type Range struct {
+	Start int
+	End   int
+}
+
+func (s *Scintilla) findAll(text string, matchCase, wholeWord bool) *C.GArray {
+	str := C.CString(text)
+	defer C.free(unsafe.Pointer(str))
+	ranges := C.g_array_new(C.FALSE, C.FALSE, C.guint(unsafe.Sizeof(C.GtkScintillaRange{})))
+	C.gtk_scintilla_find_all(s.self(), str, C.gintptr(len(text)), s.boolean(matchCase), s.boolean(wholeWord), ranges)
+	return ranges
+}
+
+func (s *Scintilla) FindAll(text string, matchCase, wholeWord bool) []Range {
+	ranges := s.findAll(text, matchCase, wholeWord)
+	defer C.g_array_unref(ranges)
+	found := unsafe.Slice((*C.GtkScintillaRange)(unsafe.Pointer(ranges.data)), int(ranges.len))
+	result := make([]Range, len(found))
+	for i, r := range found {
+		result[i] = Range{int(r.start), int(r.end)}
+	}
+	runtime.KeepAlive(s)
+	return result
+}
+
+// HighlightAll marks every match, an empty text clears the highlight
+func (s *Scintilla) HighlightAll(text string, matchCase, wholeWord bool) int {
+	ranges := s.findAll(text, matchCase, wholeWord)
+	defer C.g_array_unref(ranges)
+	C.gtk_scintilla_highlight_ranges(s.self(), ranges)
+	runtime.KeepAlive(s)
+	return int(ranges.len)
+}
+
+// HighlightTerms fills indicators[i] with value i+1 over every match of terms[i],
+// the visible lines at once and the rest of the document when idle. No terms clears the highlight
+func (s *Scintilla) HighlightTerms(terms []string, indicators []int, matchCase bool) {
+	count := len(terms)
+	if len(indicators) < count {
+		count = len(indicators)
+	}
+	if count == 0 {
+		C.gtk_scintilla_highlight_terms(s.self(), nil, nil, 0, s.boolean(matchCase))
+		runtime.KeepAlive(s)
+		return
+	}
+	strs := unsafe.Slice((**C.char)(C.malloc(C.size_t(count)*C.size_t(unsafe.Sizeof((*C.char)(nil))))), count)
+	inds := unsafe.Slice((*C.int)(C.malloc(C.size_t(count)*C.size_t(unsafe.Sizeof(C.int(0))))), count)
+	for i := 0; i < count; i++ {
+		strs[i] = C.CString(terms[i])
+		inds[i] = C.int(indicators[i])
+	}
+	C.gtk_scintilla_highlight_terms(s.self(), &strs[0], &inds[0], C.guint(count), s.boolean(matchCase))
+	runtime.KeepAlive(s)
+	for _, str := range strs {
+		C.free(unsafe.Pointer(str))
+	}
+	C.free(unsafe.Pointer(&strs[0]))
+	C.free(unsafe.Pointer(&inds[0]))
+}
+
 func (s *Scintilla) self() *C.GtkScintilla {
 	return (*C.GtkScintilla)(unsafe.Pointer(coreglib.InternObject(s).Native()))
 }
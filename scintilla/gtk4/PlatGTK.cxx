@@ -18,6 +18,10 @@
 #include <algorithm>
 #include <memory>
 #include <sstream>
+#include <list>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
 
 #include <glib.h>
 #include <gmodule.h>
@@ -86,6 +90,264 @@ void LayoutSetText(PangoLayout *layout, std::string_view text) noexcept {
 
 enum class EncodingType { singleByte, utf8, dbcs };
 
+// Incremented by FlushCachedState to discard the pooled measuring layouts
+// and the shaped text kept for drawing
+std::atomic<unsigned int> measuringGeneration {1};
+
+// Creating a PangoContext and PangoLayout for each measurement costs more than measuring
+// short segments so they are reused for the surface state they were created with.
+struct MeasuringCache {
+	UniquePangoContext context;
+	UniquePangoLayout layout;
+	unsigned int generation = 0;
+	double resolution = 0;
+	PangoDirection direction = PANGO_DIRECTION_LTR;
+	UniqueCairoFontOptions fontOptions;
+	PangoLanguage *language = nullptr;
+
+	bool Matches(double resolution_, PangoDirection direction_, const cairo_font_options_t *fontOptions_,
+		PangoLanguage *language_) const noexcept {
+		if (!layout || generation != measuringGeneration.load(std::memory_order_relaxed) ||
+			resolution != resolution_ || direction != direction_ || language != language_) {
+			return false;
+		}
+		if (!fontOptions || !fontOptions_) {
+			return !fontOptions == !fontOptions_;
+		}
+		return cairo_font_options_equal(fontOptions.get(), fontOptions_);
+	}
+};
+
+// Measuring layouts not in use, shared by all threads as the layout threads are started by
+// std::async for each layout and do not live long enough to keep their own.
+class MeasuringPool {
+	std::mutex mutex;
+	std::vector<std::unique_ptr<MeasuringCache>> idle;
+	size_t limit = 32;
+
+public:
+	std::unique_ptr<MeasuringCache> Take(double resolution, PangoDirection direction,
+		const cairo_font_options_t *fontOptions, PangoLanguage *language) {
+		std::unique_ptr<MeasuringCache> ml;
+		std::lock_guard<std::mutex> guard(mutex);
+		for (size_t i = idle.size(); i-- > 0;) {
+			if (idle[i]->Matches(resolution, direction, fontOptions, language)) {
+				ml = std::move(idle[i]);
+				idle.erase(idle.begin() + i);
+				break;
+			}
+		}
+		return ml;
+	}
+
+	// ml is released after the lock when it is not kept
+	void Give(std::unique_ptr<MeasuringCache> &ml) {
+		if (ml->generation != measuringGeneration.load(std::memory_order_relaxed)) {
+			return;
+		}
+		std::lock_guard<std::mutex> guard(mutex);
+		if (idle.size() < limit) {
+			idle.push_back(std::move(ml));
+		}
+	}
+
+	void Flush() {
+		std::vector<std::unique_ptr<MeasuringCache>> stale;
+		std::lock_guard<std::mutex> guard(mutex);
+		stale.swap(idle);
+	}
+
+	void SetLimit(size_t limit_) {
+		std::vector<std::unique_ptr<MeasuringCache>> dropped;
+		std::lock_guard<std::mutex> guard(mutex);
+		limit = limit_;
+		while (idle.size() > limit) {
+			dropped.push_back(std::move(idle.front()));
+			idle.erase(idle.begin());
+		}
+	}
+};
+
+MeasuringPool &SharedMeasuringPool() {
+	// Never destroyed, like the glyph cache, as layouts may outlive the Pango font map during exit
+	static MeasuringPool *pool = new MeasuringPool();
+	return *pool;
+}
+
+// A measuring layout taken from the pool for one measurement and returned when done
+class MeasuringLease {
+	std::unique_ptr<MeasuringCache> ml;
+public:
+	explicit MeasuringLease(std::unique_ptr<MeasuringCache> ml_) noexcept : ml(std::move(ml_)) {
+	}
+	MeasuringLease(const MeasuringLease &) = delete;
+	MeasuringLease(MeasuringLease &&) = delete;
+	MeasuringLease &operator=(const MeasuringLease &) = delete;
+	MeasuringLease &operator=(MeasuringLease &&) = delete;
+	~MeasuringLease() {
+		SharedMeasuringPool().Give(ml);
+	}
+	PangoLayout *Layout() const noexcept {
+		return ml->layout.get();
+	}
+};
+
+// What Pango shapes text with apart from its bytes and font
+struct ShapingState {
+	EncodingType et = EncodingType::singleByte;
+	CharacterSet characterSet = CharacterSet::Ansi;
+	double resolution = 0;
+	unsigned long fontOptions = 0;
+	// Pango ignores the translation of the cairo matrix
+	double xx = 1;
+	double yx = 0;
+	double xy = 0;
+	double yy = 1;
+
+	bool operator==(const ShapingState &other) const noexcept {
+		return et == other.et && characterSet == other.characterSet &&
+			resolution == other.resolution && fontOptions == other.fontOptions &&
+			xx == other.xx && yx == other.yx && xy == other.xy && yy == other.yy;
+	}
+};
+
+struct GlyphRun {
+	UniquePangoFont font;
+	UniquePangoGlyphString glyphs;
+	double width = 0;
+};
+
+// A run of text shaped into glyph runs in visual order
+struct ShapedText {
+	size_t hash = 0;
+	std::string text;
+	UniquePangoFontDescription fd;
+	ShapingState state;
+	std::vector<GlyphRun> runs;
+	size_t size = 0;
+};
+
+size_t ShapingHash(std::string_view text, const PangoFontDescription *fd, const ShapingState &state) noexcept {
+	size_t hash = std::hash<std::string_view>()(text);
+	hash = hash * 31 + pango_font_description_hash(fd);
+	hash = hash * 31 + static_cast<size_t>(state.et) * 257 + static_cast<size_t>(state.characterSet);
+	hash = hash * 31 + state.fontOptions;
+	hash = hash * 31 + std::hash<double>()(state.resolution);
+	hash = hash * 31 + std::hash<double>()(state.xx * 3 + state.yy);
+	return hash;
+}
+
+/**
+ * Least recently drawn shaped text within a budget of approximate bytes. Drawing an
+ * unchanged run of text then only shows its glyphs instead of shaping it again.
+ * Shared by all widgets as drawing happens on one thread, the mutex only guards against
+ * reading the statistics from another.
+ */
+class GlyphCache {
+	std::list<ShapedText> entries;	// most recently drawn first
+	std::unordered_map<size_t, std::list<ShapedText>::iterator> lookup;
+	size_t size = 0;
+	size_t budget = 4 * 1024 * 1024;
+	unsigned int generation = 0;
+	guint64 hits = 0;
+	guint64 misses = 0;
+
+	void Evict(size_t target) noexcept {
+		while (size > target && !entries.empty()) {
+			size -= entries.back().size;
+			lookup.erase(entries.back().hash);
+			entries.pop_back();
+		}
+	}
+
+	void Validate() noexcept {
+		const unsigned int generationNow = measuringGeneration.load(std::memory_order_relaxed);
+		if (generation != generationNow) {
+			generation = generationNow;
+			Evict(0);
+		}
+	}
+
+public:
+	std::mutex mutex;
+
+	const ShapedText *Find(size_t hash, std::string_view text, const PangoFontDescription *fd,
+		const ShapingState &state) noexcept {
+		Validate();
+		const auto it = lookup.find(hash);
+		if (it == lookup.end() || it->second->text != text || !(it->second->state == state) ||
+			!pango_font_description_equal(it->second->fd.get(), fd)) {
+			misses++;
+			return nullptr;
+		}
+		hits++;
+		entries.splice(entries.begin(), entries, it->second);
+		return &entries.front();
+	}
+
+	// Keep the runs of pll, nullptr when they can not be cached
+	const ShapedText *Add(size_t hash, std::string_view text, const PangoFontDescription *fd,
+		const ShapingState &state, PangoLayoutLine *pll) {
+		ShapedText shaped;
+		shaped.size = sizeof(ShapedText) + text.length() + 64;
+		for (GSList *item = pll ? pll->runs : nullptr; item; item = item->next) {
+			const PangoGlyphItem *run = static_cast<const PangoGlyphItem *>(item->data);
+			if (!run->item->analysis.font) {
+				return nullptr;
+			}
+			GlyphRun glyphRun;
+			glyphRun.font.reset(PANGO_FONT(g_object_ref(run->item->analysis.font)));
+			glyphRun.glyphs.reset(pango_glyph_string_copy(run->glyphs));
+			glyphRun.width = pango_units_to_double(pango_glyph_string_get_width(run->glyphs));
+			shaped.size += sizeof(GlyphRun) + run->glyphs->num_glyphs * (sizeof(PangoGlyphInfo) + sizeof(gint));
+			shaped.runs.push_back(std::move(glyphRun));
+		}
+		if (shaped.size > budget) {
+			return nullptr;
+		}
+		const auto it = lookup.find(hash);
+		if (it != lookup.end()) {
+			// Another text with the same hash
+			size -= it->second->size;
+			entries.erase(it->second);
+			lookup.erase(it);
+		}
+		Evict(budget - shaped.size);
+		shaped.hash = hash;
+		shaped.text = text;
+		shaped.fd.reset(pango_font_description_copy(fd));
+		shaped.state = state;
+		size += shaped.size;
+		entries.push_front(std::move(shaped));
+		lookup[hash] = entries.begin();
+		return &entries.front();
+	}
+
+	void SetBudget(size_t budget_) noexcept {
+		budget = budget_;
+		Evict(budget);
+	}
+
+	void Stats(ScintillaGlyphCacheStats *stats) const noexcept {
+		stats->hits = hits;
+		stats->misses = misses;
+		stats->entries = entries.size();
+		stats->size = size;
+		stats->budget = budget;
+	}
+
+	void ResetStats() noexcept {
+		hits = 0;
+		misses = 0;
+	}
+};
+
+GlyphCache &SharedGlyphCache() {
+	// Never destroyed as fonts may be released after the Pango font map during exit
+	static GlyphCache *cache = new GlyphCache();
+	return *cache;
+}
+
 // Holds a PangoFontDescription*.
 class FontHandle : public Font {
 public:
@@ -154,6 +416,9 @@ public:
 
 	void GetContextState() noexcept;
 	UniquePangoContext MeasuringContext();
+	MeasuringLease MeasuringLayout();
+	ShapingState ShapingStateFor(EncodingType etText, CharacterSet characterSetText) const noexcept;
+	void DrawShaped(XYPOSITION x, XYPOSITION ybase, const ShapedText &shaped) noexcept;
 
 	void Init(WindowID wid) override;
 	void Init(SurfaceID sid, WindowID wid) override;
@@ -376,6 +641,23 @@ UniquePangoContext SurfaceImpl::MeasuringContext() {
 	return contextMeasure;
 }
 
+MeasuringLease SurfaceImpl::MeasuringLayout() {
+	std::unique_ptr<MeasuringCache> ml = SharedMeasuringPool().Take(resolution, direction, fontOptions, language);
+	if (!ml) {
+		// created without holding the pool's lock
+		ml = std::make_unique<MeasuringCache>();
+		ml->context = MeasuringContext();
+		ml->layout.reset(pango_layout_new(ml->context.get()));
+		PLATFORM_ASSERT(ml->layout);
+		ml->generation = measuringGeneration.load(std::memory_order_relaxed);
+		ml->resolution = resolution;
+		ml->direction = direction;
+		ml->fontOptions.reset(fontOptions ? cairo_font_options_copy(fontOptions) : nullptr);
+		ml->language = language;
+	}
+	return MeasuringLease(std::move(ml));
+}
+
 void SurfaceImpl::Init(WindowID wid) {
 	widSave = wid;
 	Release();
@@ -773,12 +1055,44 @@ size_t MultiByteLenFromIconv(const Converter &conv, const char *s, size_t len) n
 
 }
 
+ShapingState SurfaceImpl::ShapingStateFor(EncodingType etText, CharacterSet characterSetText) const noexcept {
+	ShapingState state;
+	state.et = etText;
+	state.characterSet = characterSetText;
+	state.resolution = resolution;
+	state.fontOptions = fontOptions ? cairo_font_options_hash(fontOptions) : 0;
+	cairo_matrix_t matrix;
+	cairo_get_matrix(context, &matrix);
+	state.xx = matrix.xx;
+	state.yx = matrix.yx;
+	state.xy = matrix.xy;
+	state.yy = matrix.yy;
+	return state;
+}
+
+void SurfaceImpl::DrawShaped(XYPOSITION x, XYPOSITION ybase, const ShapedText &shaped) noexcept {
+	for (const GlyphRun &run : shaped.runs) {
+		cairo_move_to(context, x, ybase);
+		pango_cairo_show_glyph_string(context, run.font.get(), run.glyphs.get());
+		x += run.width;
+	}
+}
+
 void SurfaceImpl::DrawTextBase(PRectangle rc, const Font *font_, XYPOSITION ybase, std::string_view text,
 			       ColourRGBA fore) {
 	if (context) {
 		PenColourAlpha(fore);
 		const XYPOSITION xText = rc.left;
 		if (PFont(font_)->fd) {
+			GlyphCache &glyphCache = SharedGlyphCache();
+			std::lock_guard<std::mutex> guard(glyphCache.mutex);
+			const ShapingState state = ShapingStateFor(et, PFont(font_)->characterSet);
+			const size_t hash = ShapingHash(text, PFont(font_)->fd.get(), state);
+			const ShapedText *shaped = glyphCache.Find(hash, text, PFont(font_)->fd.get(), state);
+			if (shaped) {
+				DrawShaped(xText, ybase, *shaped);
+				return;
+			}
 			if (et == EncodingType::utf8) {
 				LayoutSetText(layout.get(), text);
 			} else {
@@ -792,8 +1106,13 @@ void SurfaceImpl::DrawTextBase(PRectangle rc, const Font *font_, XYPOSITION ybas
 			pango_layout_set_font_description(layout.get(), PFont(font_)->fd.get());
 			pango_cairo_update_layout(context, layout.get());
 			PangoLayoutLine *pll = pango_layout_get_line_readonly(layout.get(), 0);
-			cairo_move_to(context, xText, ybase);
-			pango_cairo_show_layout_line(context, pll);
+			shaped = glyphCache.Add(hash, text, PFont(font_)->fd.get(), state, pll);
+			if (shaped) {
+				DrawShaped(xText, ybase, *shaped);
+			} else {
+				cairo_move_to(context, xText, ybase);
+				pango_cairo_show_layout_line(context, pll);
+			}
 		}
 	}
 }
@@ -871,18 +1190,17 @@ void EquallySpaced(PangoLayout *layout, XYPOSITION *positions, size_t lenPositio
 
 void SurfaceImpl::MeasureWidths(const Font *font_, std::string_view text, XYPOSITION *positions) {
 	if (PFont(font_)->fd) {
-		UniquePangoContext contextMeasure = MeasuringContext();
-		UniquePangoLayout layoutMeasure(pango_layout_new(contextMeasure.get()));
-		PLATFORM_ASSERT(layoutMeasure);
+		const MeasuringLease lease = MeasuringLayout();
+		PangoLayout *layoutMeasure = lease.Layout();
 
-		pango_layout_set_font_description(layoutMeasure.get(), PFont(font_)->fd.get());
+		pango_layout_set_font_description(layoutMeasure, PFont(font_)->fd.get());
 		if (et == EncodingType::utf8) {
 			// Simple and direct as UTF-8 is native Pango encoding
-			ClusterIterator iti(layoutMeasure.get(), text);
+			ClusterIterator iti(layoutMeasure, text);
 			int i = iti.curIndex;
 			if (i != 0) {
 				// Unexpected start to iteration, could be bidirectional text
-				EquallySpaced(layoutMeasure.get(), positions, text.length());
+				EquallySpaced(layoutMeasure, positions, text.length());
 				return;
 			}
 			while (!iti.finished) {
@@ -929,11 +1247,11 @@ void SurfaceImpl::MeasureWidths(const Font *font_, std::string_view text, XYPOSI
 					// character byte lengths.
 					Converter convMeasure("UCS-2", charSetID, false);
 					int i = 0;
-					ClusterIterator iti(layoutMeasure.get(), utfForm);
+					ClusterIterator iti(layoutMeasure, utfForm);
 					int clusterStart = iti.curIndex;
 					if (clusterStart != 0) {
 						// Unexpected start to iteration, could be bidirectional text
-						EquallySpaced(layoutMeasure.get(), positions, text.length());
+						EquallySpaced(layoutMeasure, positions, text.length());
 						return;
 					}
 					while (!iti.finished) {
@@ -968,11 +1286,11 @@ void SurfaceImpl::MeasureWidths(const Font *font_, std::string_view text, XYPOSI
 				size_t i = 0;
 				// Each 8-bit input character may take 1 or 2 bytes in UTF-8
 				// and groups of up to 3 may be represented as ligatures.
-				ClusterIterator iti(layoutMeasure.get(), utfForm);
+				ClusterIterator iti(layoutMeasure, utfForm);
 				int clusterStart = iti.curIndex;
 				if (clusterStart != 0) {
 					// Unexpected start to iteration, could be bidirectional text
-					EquallySpaced(layoutMeasure.get(), positions, lenPositions);
+					EquallySpaced(layoutMeasure, positions, lenPositions);
 					return;
 				}
 				while (!iti.finished) {
@@ -985,7 +1303,7 @@ void SurfaceImpl::MeasureWidths(const Font *font_, std::string_view text, XYPOSI
 #ifdef DEBUG
 						fprintf(stderr, "MeasureWidths: result too long.\n");
 #endif
-						EquallySpaced(layoutMeasure.get(), positions, lenPositions);
+						EquallySpaced(layoutMeasure, positions, lenPositions);
 						return;
 					}
 					PLATFORM_ASSERT(ligatureLength > 0 && ligatureLength <= 3);
@@ -1036,12 +1354,26 @@ void SurfaceImpl::DrawTextBaseUTF8(PRectangle rc, const Font *font_, XYPOSITION
 		PenColourAlpha(fore);
 		const XYPOSITION xText = rc.left;
 		if (PFont(font_)->fd) {
+			GlyphCache &glyphCache = SharedGlyphCache();
+			std::lock_guard<std::mutex> guard(glyphCache.mutex);
+			const ShapingState state = ShapingStateFor(EncodingType::utf8, PFont(font_)->characterSet);
+			const size_t hash = ShapingHash(text, PFont(font_)->fd.get(), state);
+			const ShapedText *shaped = glyphCache.Find(hash, text, PFont(font_)->fd.get(), state);
+			if (shaped) {
+				DrawShaped(xText, ybase, *shaped);
+				return;
+			}
 			LayoutSetText(layout.get(), text);
 			pango_layout_set_font_description(layout.get(), PFont(font_)->fd.get());
 			pango_cairo_update_layout(context, layout.get());
 			PangoLayoutLine *pll = pango_layout_get_line_readonly(layout.get(), 0);
-			cairo_move_to(context, xText, ybase);
-			pango_cairo_show_layout_line(context, pll);
+			shaped = glyphCache.Add(hash, text, PFont(font_)->fd.get(), state, pll);
+			if (shaped) {
+				DrawShaped(xText, ybase, *shaped);
+			} else {
+				cairo_move_to(context, xText, ybase);
+				pango_cairo_show_layout_line(context, pll);
+			}
 		}
 	}
 }
@@ -1072,53 +1404,58 @@ void SurfaceImpl::DrawTextTransparentUTF8(PRectangle rc, const Font *font_, XYPO
 
 void SurfaceImpl::MeasureWidthsUTF8(const Font *font_, std::string_view text, XYPOSITION *positions) {
 	if (PFont(font_)->fd) {
-		UniquePangoContext contextMeasure = MeasuringContext();
-		UniquePangoLayout layoutMeasure(pango_layout_new(contextMeasure.get()));
-		PLATFORM_ASSERT(layoutMeasure);
-
-		pango_layout_set_font_description(layoutMeasure.get(), PFont(font_)->fd.get());
-		// Simple and direct as UTF-8 is native Pango encoding
-		ClusterIterator iti(layoutMeasure.get(), text);
-		int i = iti.curIndex;
-		if (i != 0) {
-			// Unexpected start to iteration, could be bidirectional text
-			EquallySpaced(layoutMeasure.get(), positions, text.length());
-			return;
-		}
-		while (!iti.finished) {
-			iti.Next();
-			if (iti.curIndex < i) {
-				// Backwards movement indicater bidirectional.
-				// Divide into ASCII prefix and non-ASCII suffix as this is common case
-				// and produces accurate positions for the ASCII prefix.
-				size_t lenASCII=0;
-				while (lenASCII<text.length() && IsASCII(text[lenASCII])) {
-					lenASCII++;
+		bool bidirectional = false;
+		{
+			const MeasuringLease lease = MeasuringLayout();
+			PangoLayout *layoutMeasure = lease.Layout();
+			pango_layout_set_font_description(layoutMeasure, PFont(font_)->fd.get());
+			// Simple and direct as UTF-8 is native Pango encoding
+			ClusterIterator iti(layoutMeasure, text);
+			int i = iti.curIndex;
+			if (i != 0) {
+				// Unexpected start to iteration, could be bidirectional text
+				EquallySpaced(layoutMeasure, positions, text.length());
+				return;
+			}
+			while (!iti.finished) {
+				iti.Next();
+				if (iti.curIndex < i) {
+					// Backwards movement indicater bidirectional.
+					bidirectional = true;
+					break;
 				}
-				const std::string_view asciiPrefix = text.substr(0, lenASCII);
-				const std::string_view bidiSuffix = text.substr(lenASCII);
-				// Recurse for ASCII prefix.
-				MeasureWidthsUTF8(font_, asciiPrefix, positions);
-				// Measure the whole bidiSuffix and spread its width evenly
-				const XYPOSITION endASCII = positions[lenASCII-1];
-				const XYPOSITION widthBidi = WidthText(font_, bidiSuffix);
-				const XYPOSITION widthByteBidi = widthBidi / bidiSuffix.length();
-				for (size_t bidiPos=0; bidiPos<bidiSuffix.length(); bidiPos++) {
-					positions[bidiPos+lenASCII] = endASCII + widthByteBidi * (bidiPos + 1);
+				const int places = iti.curIndex - i;
+				while (i < iti.curIndex) {
+					// Evenly distribute space among bytes of this cluster.
+					// Would be better to find number of characters and then
+					// divide evenly between characters with each byte of a character
+					// being at the same position.
+					positions[i] = iti.position - (iti.curIndex - 1 - i) * iti.distance / places;
+					i++;
 				}
-				return;
 			}
-			const int places = iti.curIndex - i;
-			while (i < iti.curIndex) {
-				// Evenly distribute space among bytes of this cluster.
-				// Would be better to find number of characters and then
-				// divide evenly between characters with each byte of a character
-				// being at the same position.
-				positions[i] = iti.position - (iti.curIndex - 1 - i) * iti.distance / places;
-				i++;
+			PLATFORM_ASSERT(bidirectional || static_cast<size_t>(i) == text.length());
+		}
+		if (bidirectional) {
+			// The measuring layout is back in the pool before recursing.
+			// Divide into ASCII prefix and non-ASCII suffix as this is common case
+			// and produces accurate positions for the ASCII prefix.
+			size_t lenASCII=0;
+			while (lenASCII<text.length() && IsASCII(text[lenASCII])) {
+				lenASCII++;
+			}
+			const std::string_view asciiPrefix = text.substr(0, lenASCII);
+			const std::string_view bidiSuffix = text.substr(lenASCII);
+			// Recurse for ASCII prefix.
+			MeasureWidthsUTF8(font_, asciiPrefix, positions);
+			// Measure the whole bidiSuffix and spread its width evenly
+			const XYPOSITION endASCII = positions[lenASCII-1];
+			const XYPOSITION widthBidi = WidthText(font_, bidiSuffix);
+			const XYPOSITION widthByteBidi = widthBidi / bidiSuffix.length();
+			for (size_t bidiPos=0; bidiPos<bidiSuffix.length(); bidiPos++) {
+				positions[bidiPos+lenASCII] = endASCII + widthByteBidi * (bidiPos + 1);
 			}
 		}
-		PLATFORM_ASSERT(static_cast<size_t>(i) == text.length());
 	} else {
 		// No font so return an ascending range of values
 		for (size_t i = 0; i < text.length(); i++) {
@@ -1184,7 +1521,11 @@ void SurfaceImpl::PopClip() {
 	cairo_restore(context);
 }
 
-void SurfaceImpl::FlushCachedState() {}
+void SurfaceImpl::FlushCachedState() {
+	// Measuring layouts and shaped text are rebuilt with the current font map and options on next use
+	measuringGeneration.fetch_add(1, std::memory_order_relaxed);
+	SharedMeasuringPool().Flush();
+}
 
 void SurfaceImpl::FlushDrawing() {
 }
@@ -1983,6 +2324,31 @@ void Platform::Assert(const char *c, const char *file, int line) noexcept {
 	abort();
 }
 
+/* Hits and size of the shaped text kept for drawing by all widgets */
+void scintilla_glyph_cache_get_stats(ScintillaGlyphCacheStats *stats) {
+	GlyphCache &glyphCache = SharedGlyphCache();
+	std::lock_guard<std::mutex> guard(glyphCache.mutex);
+	glyphCache.Stats(stats);
+}
+
+void scintilla_glyph_cache_reset_stats(void) {
+	GlyphCache &glyphCache = SharedGlyphCache();
+	std::lock_guard<std::mutex> guard(glyphCache.mutex);
+	glyphCache.ResetStats();
+}
+
+/* Approximate bytes of shaped text kept, 0 shapes text every time it is drawn */
+void scintilla_glyph_cache_set_budget(gsize budget) {
+	GlyphCache &glyphCache = SharedGlyphCache();
+	std::lock_guard<std::mutex> guard(glyphCache.mutex);
+	glyphCache.SetBudget(budget);
+}
+
+/* Measuring layouts kept for reuse by all threads, 0 creates one for each measurement */
+void scintilla_measuring_pool_set_size(gsize size) {
+	SharedMeasuringPool().SetLimit(size);
+}
+
 void Platform_Initialise() {
 }
 
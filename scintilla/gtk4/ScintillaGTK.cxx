@@ -60,6 +60,9 @@
 #include "Decoration.h"
 #include "CaseFolder.h"
 #include "Document.h"
+#include "TrigramIndex.h"
+#include "AhoCorasick.h"
+#include "LexerPool.h"
 #include "CaseConvert.h"
 #include "UniConversion.h"
 #include "Selection.h"
@@ -106,6 +109,42 @@ GtkWidget *PWidget(const Window &w) noexcept {
 	return static_cast<GtkWidget *>(w.GetID());
 }
 
+// The text area: ScintillaGTK appends the recorded lines as render nodes when it is snapshot
+struct ScintillaText {
+	GtkWidget parent;
+	void (*snapshotText)(GtkSnapshot *snapshot, void *data);
+	void *data;
+};
+
+struct ScintillaTextClass {
+	GtkWidgetClass parent_class;
+};
+
+G_DEFINE_TYPE(ScintillaText, scintilla_text, GTK_TYPE_WIDGET)
+
+void scintilla_text_snapshot(GtkWidget *widget, GtkSnapshot *snapshot) {
+	ScintillaText *text = reinterpret_cast<ScintillaText *>(widget);
+	if (text->snapshotText) {
+		text->snapshotText(snapshot, text->data);
+	}
+}
+
+void scintilla_text_class_init(ScintillaTextClass *klass) {
+	GTK_WIDGET_CLASS(klass)->snapshot = scintilla_text_snapshot;
+}
+
+void scintilla_text_init(ScintillaText *text) {
+	text->snapshotText = nullptr;
+	text->data = nullptr;
+}
+
+GtkWidget *scintilla_text_new(void (*snapshotText)(GtkSnapshot *snapshot, void *data), void *data) {
+	ScintillaText *text = static_cast<ScintillaText *>(g_object_new(scintilla_text_get_type(), nullptr));
+	text->snapshotText = snapshotText;
+	text->data = data;
+	return GTK_WIDGET(text);
+}
+
 bool SettingGet(GtkSettings *settings, const gchar *name, gpointer value) noexcept {
 	if (!settings) {
 		return false;
@@ -185,6 +224,7 @@ ScintillaGTK::~ScintillaGTK() {
 		scrollBarIdleID = 0;
 	}
 	ClearPrimarySelection();
+	DropLineNodes();
 	//wPreedit.Destroy();
 	if (settingsHandlerId) {
 		g_signal_handler_disconnect(settings, settingsHandlerId);
@@ -269,6 +309,8 @@ void ScintillaGTK::Map(GtkWidget *widget) {
 void ScintillaGTK::UnMapThis() {
 	try {
 		//Platform::DebugPrintf("ScintillaGTK::unmap this\n");
+		CancelTextDraw();
+		DropLineNodes();
 		DropGraphics();
 		parentClass->unmap(PWidget(wMain));
 		//gtk_widget_unmap(PWidget(wText));
@@ -467,10 +509,9 @@ void ScintillaGTK::Init() {
 	gtk_widget_add_controller(wid, scrollEvent);
 	
 
-	wText = gtk_drawing_area_new();
+	wText = scintilla_text_new(SnapshotText, this);
 	GtkWidget* widtxt = PWidget(wText);
 	gtk_widget_set_parent(widtxt, wid);
-	gtk_drawing_area_set_draw_func(GTK_DRAWING_AREA(widtxt), (GtkDrawingAreaDrawFunc)ScintillaGTK::DrawTextCb, this, nullptr);
 	gtk_widget_set_size_request(widtxt, 100, 100);
 
 	adjustmentv = GTK_ADJUSTMENT(gtk_adjustment_new(0.0, 0.0, 201.0, 1.0, 20.0, 20.0));
@@ -543,20 +584,6 @@ void ScintillaGTK::Init() {
 	vs.indicators[SC_INDICATOR_TARGET] = Indicator(IndicatorStyle::StraightBox, colourIME);
 
 	fontOptionsPrevious = FontOptions(PWidget(wText));
-
-	// avoid over-drawing
-	constexpr guint FrameRate = 30;
-	drawTimer = g_timeout_add(1000 / FrameRate, [](gpointer data)->gboolean
-		{
-			auto self = (ScintillaGTK*)data;
-			if (self->needDraw)
-			{
-				self->needDraw = false;
-				gtk_widget_queue_draw(PWidget(self->wText));
-			}
-			return G_SOURCE_CONTINUE;
-		}, this
-	);
 }
 
 void ScintillaGTK::Finalise() {
@@ -564,7 +591,7 @@ void ScintillaGTK::Finalise() {
 		FineTickerCancel(static_cast<TickReason>(tr));
 	}
 
-	g_source_remove(drawTimer);
+	CancelTextDraw();
 	ScintillaBase::Finalise();
 }
 
@@ -766,6 +793,45 @@ sptr_t ScintillaGTK::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	return 0;
 }
 
+// Set every style and element colour of a table and then invalidate once so the
+// ViewStyle and its fonts are refreshed a single time on the next paint instead of
+// after each of the messages that would otherwise be sent.
+void ScintillaGTK::ApplyStyles(const ScintillaStyleDef *styles, int count, const ScintillaElementColour *elements, int elementCount) {
+	if (count > 0) {
+		vs.EnsureStyle(count - 1);
+	}
+	for (int i = 0; i < count; i++) {
+		Style &style = vs.styles[i];
+		style.fore = ColourRGBA::FromIpRGB(styles[i].fore);
+		style.back = ColourRGBA::FromIpRGB(styles[i].back);
+		if (styles[i].font) {
+			vs.SetStyleFontName(i, styles[i].font);
+		}
+		style.size = styles[i].size * FontSizeMultiplier;
+		style.weight = styles[i].bold ? FontWeight::Bold : FontWeight::Normal;
+		style.italic = styles[i].italic != 0;
+		style.underline = styles[i].underline != 0;
+	}
+	for (int i = 0; i < elementCount; i++) {
+		vs.SetElementColour(static_cast<Element>(elements[i].element), ColourRGBA(static_cast<int>(elements[i].colour)));
+	}
+	InvalidateStyleRedraw();
+}
+
+// The measured seconds per byte for styling the document and wrapping lines in this view.
+void ScintillaGTK::ActionDurations(double *styleOneByte, double *wrapOneByte) const noexcept {
+	*styleOneByte = pdoc->durationStyleOneByte.Duration();
+	*wrapOneByte = durationWrapOneByte.Duration();
+}
+
+void ScintillaGTK::FrameStats(ScintillaFrameStats *stats) const noexcept {
+	*stats = frameStats;
+}
+
+void ScintillaGTK::ResetFrameStats() noexcept {
+	frameStats = {};
+}
+
 sptr_t ScintillaGTK::DefWndProc(Message, uptr_t, sptr_t) {
 	return 0;
 }
@@ -861,7 +927,8 @@ bool ScintillaGTK::PaintContains(PRectangle rc) {
 
 // Redraw all of text area. This paint will not be abandoned.
 void ScintillaGTK::FullPaint() {
-	wText.InvalidateAll();
+	ClearLineNodes(0, lineNodes.size());
+	QueueTextDraw();
 }
 
 void ScintillaGTK::SetClientRectangle() {
@@ -886,9 +953,32 @@ PRectangle ScintillaGTK::GetClientRectangle() const {
 	return rc;
 }
 
-void ScintillaGTK::ScrollText(Sci::Line linesToMove) {
+void ScintillaGTK::ScrollText(Sci::Line) {
+	// Recorded lines are kept by display line so the next frame moves them with the
+	// scroll and only paints the lines scrolled into view
 	NotifyUpdateUI();
-	Redraw();
+	QueueTextDraw();
+}
+
+// Editor invalidations go straight to the text area and only drop the recorded
+// lines they touch, the main widget only holds the scroll bars.
+void ScintillaGTK::Redraw() {
+	FullPaint();
+}
+
+void ScintillaGTK::RedrawRect(PRectangle rc) {
+	const int lineHeight = vs.lineHeight;
+	if (lineHeight <= 0 || rc.Empty()) {
+		return;
+	}
+	// rows of the invalidated area counted from the recorded top line
+	const Sci::Line offset = topLine - lineNodesTop;
+	const Sci::Line first = std::max<Sci::Line>(static_cast<Sci::Line>(std::floor(rc.top / lineHeight)) + offset, 0);
+	const Sci::Line last = static_cast<Sci::Line>(std::ceil(rc.bottom / lineHeight)) + offset;
+	if (last > first) {
+		ClearLineNodes(first, last);
+	}
+	QueueTextDraw();
 }
 
 void ScintillaGTK::SetVerticalScrollPos() {
@@ -2228,63 +2318,225 @@ void ScintillaGTK::Destroy(GObject *object) {
 void ScintillaGTK::CheckForFontOptionChange() {
 	const FontOptions fontOptionsNow(PWidget(wText));
 	if (!(fontOptionsNow == fontOptionsPrevious)) {
-		// Clear position caches
+		// Clear position caches and the layouts kept for measuring text
 		InvalidateStyleData();
+		std::unique_ptr<Surface> surfaceMeasure(Surface::Allocate(Technology::Default));
+		surfaceMeasure->Init(PWidget(wText));
+		surfaceMeasure->FlushCachedState();
 	}
 	fontOptionsPrevious = fontOptionsNow;
 }
 
-gboolean ScintillaGTK::DrawTextThis(cairo_t *cr) {
+// Paint the clip area of cr with the editor.
+void ScintillaGTK::PaintText(cairo_t *cr) {
+	paintState = PaintState::painting;
+	repaintFullWindow = false;
+
+	rcPaint = GetClientRectangle();
+
+	cairo_rectangle_list_t *oldRgnUpdate = rgnUpdate;
+	rgnUpdate = cairo_copy_clip_rectangle_list(cr);
+	if (rgnUpdate && rgnUpdate->status != CAIRO_STATUS_SUCCESS) {
+		// If not successful then ignore
+		fprintf(stderr, "PaintText failed to copy update region %d [%d]\n", rgnUpdate->status, rgnUpdate->num_rectangles);
+		cairo_rectangle_list_destroy(rgnUpdate);
+		rgnUpdate = nullptr;
+	}
+
+	double x1, y1, x2, y2;
+	cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+	rcPaint.left = x1;
+	rcPaint.top = y1;
+	rcPaint.right = x2;
+	rcPaint.bottom = y2;
+	PRectangle rcClient = GetClientRectangle();
+	paintingAllText = rcPaint.Contains(rcClient);
+	std::unique_ptr<Surface> surfaceWindow(Surface::Allocate(Technology::Default));
+	surfaceWindow->Init(cr, PWidget(wText));
+	Paint(surfaceWindow.get(), rcPaint);
+	surfaceWindow->Release();
+	if ((paintState == PaintState::abandoned) || repaintFullWindow) {
+		// Painting area was insufficient to cover new styling or brace highlight positions
+		FullPaint();
+	}
+	paintState = PaintState::notPainting;
+	repaintFullWindow = false;
+
+	if (rgnUpdate) {
+		cairo_rectangle_list_destroy(rgnUpdate);
+	}
+	rgnUpdate = oldRgnUpdate;
+	paintState = PaintState::notPainting;
+}
+
+// Paint the display lines on screen in rows [first, last) with one Paint into an image and
+// set nodes[row] to a texture node for each of them with its own origin, so a line can be
+// appended at any row while it stays in view. The textures share the image's pixels.
+void ScintillaGTK::RecordLines(size_t first, size_t last, int width, int lineHeight, std::vector<GskRenderNode *> &nodes) {
+	const int scale = gtk_widget_get_scale_factor(PWidget(wText));
+	const int runHeight = static_cast<int>(last - first) * lineHeight;
+	cairo_surface_t *image = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width * scale, runHeight * scale);
+	if (cairo_surface_status(image) != CAIRO_STATUS_SUCCESS) {
+		cairo_surface_destroy(image);
+		return;
+	}
+	cairo_surface_set_device_scale(image, scale, scale);
+	cairo_t *cr = cairo_create(image);
+	const double top = static_cast<double>(first) * lineHeight;
+	cairo_translate(cr, 0, -top);
+	cairo_rectangle(cr, 0, top, width, runHeight);
+	cairo_clip(cr);
+	recordingFirst = first;
+	recordingLast = last;
+	recordingInvalidated = false;
+	PaintText(cr);
+	recordingFirst = 0;
+	recordingLast = 0;
+	cairo_destroy(cr);
+	cairo_surface_flush(image);
+
+	// GDK_MEMORY_DEFAULT is the layout of CAIRO_FORMAT_ARGB32
+	const gsize stride = cairo_image_surface_get_stride(image);
+	const gsize rowBytes = stride * lineHeight * scale;
+	GBytes *pixels = g_bytes_new_with_free_func(cairo_image_surface_get_data(image), rowBytes * (last - first),
+		reinterpret_cast<GDestroyNotify>(cairo_surface_destroy), image);
+	graphene_rect_t bounds;
+	graphene_rect_init(&bounds, 0, 0, static_cast<float>(width), static_cast<float>(lineHeight));
+	for (size_t row = first; row < last; row++) {
+		GBytes *slice = g_bytes_new_from_bytes(pixels, (row - first) * rowBytes, rowBytes);
+		GdkTexture *texture = gdk_memory_texture_new(width * scale, lineHeight * scale, GDK_MEMORY_DEFAULT, slice, stride);
+		g_bytes_unref(slice);
+		nodes[row] = gsk_texture_node_new(texture, &bounds);
+		g_object_unref(texture);
+	}
+	g_bytes_unref(pixels);
+}
+
+void ScintillaGTK::ClearLineNodes(size_t first, size_t last) noexcept {
+	if (first < recordingLast && recordingFirst < last) {
+		recordingInvalidated = true;
+	}
+	for (size_t row = first; row < last && row < lineNodes.size(); row++) {
+		if (lineNodes[row]) {
+			gsk_render_node_unref(lineNodes[row]);
+			lineNodes[row] = nullptr;
+		}
+	}
+}
+
+void ScintillaGTK::DropLineNodes() noexcept {
+	ClearLineNodes(0, lineNodes.size());
+	lineNodes.clear();
+}
+
+// Move the recorded lines to the rows they have with top as the first display line.
+void ScintillaGTK::RebaseLineNodes(Sci::Line top) noexcept {
+	const Sci::Line shift = top - lineNodesTop;
+	lineNodesTop = top;
+	const Sci::Line rows = static_cast<Sci::Line>(lineNodes.size());
+	if (shift == 0 || rows == 0) {
+		return;
+	}
+	if (std::abs(shift) >= rows) {
+		ClearLineNodes(0, rows);
+	} else if (shift > 0) {
+		ClearLineNodes(0, shift);
+		std::rotate(lineNodes.begin(), lineNodes.begin() + shift, lineNodes.end());
+	} else {
+		ClearLineNodes(rows + shift, rows);
+		std::rotate(lineNodes.begin(), lineNodes.end() + shift, lineNodes.end());
+	}
+}
+
+void ScintillaGTK::SnapshotTextThis(GtkSnapshot *snapshot) {
 	try {
 		CheckForFontOptionChange();
+		const gint64 frameStart = g_get_monotonic_time();
 
-		paintState = PaintState::painting;
-		repaintFullWindow = false;
-
-		rcPaint = GetClientRectangle();
+		const int width = gtk_widget_get_width(PWidget(wText));
+		const int height = gtk_widget_get_height(PWidget(wText));
+		const int lineHeight = vs.lineHeight;
+		if (width <= 0 || height <= 0 || lineHeight <= 0) {
+			return;
+		}
+		if (width != lineNodesWidth || lineHeight != lineNodesHeight) {
+			DropLineNodes();
+			lineNodesWidth = width;
+			lineNodesHeight = lineHeight;
+		}
 
-		cairo_rectangle_list_t *oldRgnUpdate = rgnUpdate;
-		rgnUpdate = cairo_copy_clip_rectangle_list(cr);
-		if (rgnUpdate && rgnUpdate->status != CAIRO_STATUS_SUCCESS) {
-			// If not successful then ignore
-			fprintf(stderr, "DrawTextThis failed to copy update region %d [%d]\n", rgnUpdate->status, rgnUpdate->num_rectangles);
-			cairo_rectangle_list_destroy(rgnUpdate);
-			rgnUpdate = nullptr;
+		// Lines still in view after a scroll are reused, each run of the rest is painted at once
+		const bool scrolled = !lineNodes.empty() && lineNodesTop != topLine;
+		RebaseLineNodes(topLine);
+		const size_t rows = (height + lineHeight - 1) / lineHeight;
+		if (rows < lineNodes.size()) {
+			ClearLineNodes(rows, lineNodes.size());
+		}
+		lineNodes.resize(rows, nullptr);
+		if (std::find(lineNodes.begin(), lineNodes.end(), nullptr) != lineNodes.end()) {
+			// style the whole view once instead of for each line painted
+			StyleAreaBounded(GetClientRectangle(), false);
 		}
 
-		double x1, y1, x2, y2;
-		cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
-		rcPaint.left = x1;
-		rcPaint.top = y1;
-		rcPaint.right = x2;
-		rcPaint.bottom = y2;
-		PRectangle rcClient = GetClientRectangle();
-		paintingAllText = rcPaint.Contains(rcClient);
-		std::unique_ptr<Surface> surfaceWindow(Surface::Allocate(Technology::Default));
-		surfaceWindow->Init(cr, PWidget(wText));
-		Paint(surfaceWindow.get(), rcPaint);
-		surfaceWindow->Release();
-		if ((paintState == PaintState::abandoned) || repaintFullWindow) {
-			// Painting area was insufficient to cover new styling or brace highlight positions
-			FullPaint();
+		graphene_rect_t clip;
+		graphene_rect_init(&clip, 0, 0, static_cast<float>(width), static_cast<float>(height));
+		gtk_snapshot_push_clip(snapshot, &clip);
+		std::vector<GskRenderNode *> nodes(rows, nullptr);
+		guint64 recorded = 0;
+		for (size_t row = 0; row < rows;) {
+			if (row < lineNodes.size() && lineNodes[row]) {
+				nodes[row] = gsk_render_node_ref(lineNodes[row]);
+				row++;
+				continue;
+			}
+			size_t last = row + 1;
+			while (last < rows && !(last < lineNodes.size() && lineNodes[last])) {
+				last++;
+			}
+			RecordLines(row, last, width, lineHeight, nodes);
+			recorded += last - row;
+			// painting may have invalidated the lines again, they are then recorded on the next frame
+			if (!recordingInvalidated) {
+				for (size_t line = row; line < last && line < lineNodes.size(); line++) {
+					if (nodes[line]) {
+						lineNodes[line] = gsk_render_node_ref(nodes[line]);
+					}
+				}
+			}
+			row = last;
 		}
-		paintState = PaintState::notPainting;
-		repaintFullWindow = false;
+		for (size_t row = 0; row < rows; row++) {
+			GskRenderNode *node = nodes[row];
+			if (!node) {
+				continue;
+			}
+			graphene_point_t origin;
+			graphene_point_init(&origin, 0, static_cast<float>(row * lineHeight));
+			gtk_snapshot_save(snapshot);
+			gtk_snapshot_translate(snapshot, &origin);
+			gtk_snapshot_append_node(snapshot, node);
+			gtk_snapshot_restore(snapshot);
+			gsk_render_node_unref(node);
+		}
+		gtk_snapshot_pop(snapshot);
 
-		if (rgnUpdate) {
-			cairo_rectangle_list_destroy(rgnUpdate);
+		const gint64 frameTime = g_get_monotonic_time() - frameStart;
+		frameStats.frames++;
+		if (scrolled && recorded < rows) {
+			frameStats.scrolledFrames++;
 		}
-		rgnUpdate = oldRgnUpdate;
-		paintState = PaintState::notPainting;
+		frameStats.recordedLines += recorded;
+		frameStats.totalTime += frameTime;
+		frameStats.maxTime = std::max(frameStats.maxTime, frameTime);
 	} catch (...) {
 		errorStatus = Status::Failure;
 	}
-
-	return FALSE;
 }
 
-gboolean ScintillaGTK::DrawTextCb(GtkWidget *, cairo_t *cr, int width, int height, ScintillaGTK *sciThis) {
-	return sciThis->DrawTextThis(cr);
+void ScintillaGTK::SnapshotText(GtkSnapshot *snapshot, void *data) {
+	ScintillaGTK *sciThis = static_cast<ScintillaGTK *>(data);
+	sciThis->needDraw = false; // drawn with the current state, a pending tick has nothing left to do
+	sciThis->SnapshotTextThis(snapshot);
 }
 
 void ScintillaGTK::DrawThis(GtkSnapshot* snapshot) {
@@ -2306,7 +2558,6 @@ void ScintillaGTK::DrawThis(GtkSnapshot* snapshot) {
 			gtk_style_context_restore(styleContext);
 		}
 #endif
-		needDraw = true; // lazy draw
 		parentClass->snapshot(PWidget(wMain), snapshot);
 
 		//gtk_container_propagate_draw(
@@ -2324,6 +2575,33 @@ void ScintillaGTK::DrawMain(GtkWidget *widget, GtkSnapshot* snapshot) {
 	sciThis->DrawThis(snapshot);
 }
 
+// Redraws of the text are paced by the frame clock: any number of invalidations
+// within a frame wake the widget once and nothing runs while it is clean or unmapped.
+void ScintillaGTK::QueueTextDraw() {
+	needDraw = true;
+	if (!drawTick && gtk_widget_get_mapped(PWidget(wText))) {
+		drawTick = gtk_widget_add_tick_callback(PWidget(wText), DrawTick, this, nullptr);
+	}
+}
+
+void ScintillaGTK::CancelTextDraw() noexcept {
+	if (drawTick) {
+		gtk_widget_remove_tick_callback(PWidget(wText), drawTick);
+		drawTick = 0;
+	}
+	needDraw = false;
+}
+
+gboolean ScintillaGTK::DrawTick(GtkWidget *, GdkFrameClock *, gpointer data) {
+	ScintillaGTK *sciThis = static_cast<ScintillaGTK *>(data);
+	sciThis->drawTick = 0;
+	if (sciThis->needDraw) {
+		sciThis->needDraw = false;
+		gtk_widget_queue_draw(PWidget(sciThis->wText));
+	}
+	return G_SOURCE_REMOVE;
+}
+
 void ScintillaGTK::ScrollSignal(GtkAdjustment *adj, ScintillaGTK *sciThis) {
 	try {
 		sciThis->ScrollTo(static_cast<int>(gtk_adjustment_get_value(adj)), false);
@@ -2579,6 +2857,225 @@ gintptr scintilla_object_send_message(ScintillaObject *sci, unsigned int iMessag
 	return scintilla_send_message(sci, iMessage, wParam, lParam);
 }
 
+/* ILoader access for C callers filling a document from a worker thread */
+int scintilla_loader_add_data(void *loader, const char *data, gintptr length) {
+	return static_cast<ILoader *>(loader)->AddData(data, length);
+}
+
+void *scintilla_loader_convert_to_document(void *loader) {
+	return static_cast<ILoader *>(loader)->ConvertToDocument();
+}
+
+int scintilla_loader_release(void *loader) {
+	return static_cast<ILoader *>(loader)->Release();
+}
+
+/* Read-only document whose text is a mapping of the file at path */
+void *scintilla_document_new_mapped(const char *path, GError **error) {
+	GMappedFile *file = g_mapped_file_new(path, FALSE, error);
+	if (!file)
+		return nullptr;
+
+	const Sci::Position length = g_mapped_file_get_length(file);
+	const char *contents = g_mapped_file_get_contents(file);
+	const DocumentOption options = (length > INT32_MAX) ? DocumentOption::TextLarge : DocumentOption::Default;
+
+	Document *doc = nullptr;
+	try {
+		doc = new Document(options);
+	} catch (...) {
+		g_mapped_file_unref(file);
+		g_set_error_literal(error, G_FILE_ERROR, G_FILE_ERROR_NOMEM, "not enough memory to map file");
+		return nullptr;
+	}
+	doc->AddRef();
+
+	try {
+		// The mapping lives as long as the document, empty files have no contents
+		std::shared_ptr<const char> text(contents ? contents : "", [file](const char *) noexcept {
+			g_mapped_file_unref(file);
+		});
+		doc->SetMappedText(std::move(text), length);
+	} catch (...) {
+		doc->Release();
+		g_set_error_literal(error, G_FILE_ERROR, G_FILE_ERROR_NOMEM, "not enough memory to map file");
+		return nullptr;
+	}
+	return doc->AsDocumentEditable();
+}
+
+/* Replace every range of an indicator, ranges holds count (start, end) pairs */
+void scintilla_object_replace_indicator_ranges(ScintillaObject *sci, int indicator, int value, const gintptr *ranges, gsize count) {
+	ScintillaGTK *psci = static_cast<ScintillaGTK *>(sci->pscin);
+	static_assert(sizeof(gintptr) == sizeof(Sci::Position));
+	psci->pdoc->DecorationReplaceRanges(indicator, value, reinterpret_cast<const Sci::Position *>(ranges), count);
+}
+
+static Document *DocumentFromPointer(void *doc) noexcept {
+	return static_cast<Document *>(static_cast<IDocumentEditable *>(doc));
+}
+
+/* Keep the document's text as it is now for readers on any thread: pointers into it taken
+ * while pinned stay valid and unchanged until scintilla_text_pin_release, edits are still
+ * accepted and move the document to a copy of its text first. NULL without memory */
+void *scintilla_document_pin_text(void *doc) {
+	try {
+		return new std::shared_ptr<PinnedText>(DocumentFromPointer(doc)->PinText());
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+/* Whether an edit now would copy the text, moving the gap would too */
+gboolean scintilla_document_text_pinned(void *doc) {
+	return DocumentFromPointer(doc)->TextPinned();
+}
+
+/* Whether the document still holds the text pinned by pin */
+gboolean scintilla_document_text_unchanged(void *doc, void *pin) {
+	return DocumentFromPointer(doc)->TextUnchangedSince(**static_cast<std::shared_ptr<PinnedText> *>(pin));
+}
+
+/* May be called on any thread */
+void scintilla_text_pin_release(void *pin) {
+	delete static_cast<std::shared_ptr<PinnedText> *>(pin);
+}
+
+/* Trigram index sized for the document's text, built by scintilla_trigram_index_build
+ * on any thread from the two halves of the gap buffer while the text does not change
+ * and then attached to the document */
+void *scintilla_trigram_index_new(void *doc, gsize budget, guint *blocks) {
+	try {
+		Document *pdoc = DocumentFromPointer(doc);
+		TrigramIndex *index = new TrigramIndex(pdoc->Length(), budget);
+		*blocks = static_cast<guint>(index->Blocks());
+		// edits from now on are replayed when the index is set
+		pdoc->StartTrigramBuild();
+		return index;
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void scintilla_trigram_index_build(void *index, const char *before, gsize beforeLength, const char *after, gsize afterLength, guint first, guint last) {
+	SplitView text;
+	text.segment1 = before;
+	text.length1 = beforeLength;
+	text.segment2 = after ? after - beforeLength : before;
+	text.length = beforeLength + afterLength;
+	static_cast<TrigramIndex *>(index)->BuildBlocks(text, first, last);
+}
+
+void scintilla_trigram_index_free(void *index) {
+	delete static_cast<TrigramIndex *>(index);
+}
+
+/* The document takes ownership of index and keeps it up to date, NULL removes the index */
+void scintilla_document_set_trigram_index(void *doc, void *index) {
+	try {
+		DocumentFromPointer(doc)->SetTrigramIndex(std::unique_ptr<TrigramIndex>(static_cast<TrigramIndex *>(index)));
+	} catch (...) {
+		// the index could not catch up with the edits, the document is left without one
+	}
+}
+
+gsize scintilla_document_get_trigram_index_memory(void *doc) {
+	const TrigramIndex *index = DocumentFromPointer(doc)->GetTrigramIndex();
+	return index ? index->MemoryUse() : 0;
+}
+
+/* Append the (start, end) pairs where a match of text may start to ranges,
+ * FALSE when the document has no index or it can not narrow this search */
+gboolean scintilla_document_trigram_candidates(void *doc, const char *text, gintptr length, gboolean matchCase, GArray *ranges) {
+	const Document *pdoc = DocumentFromPointer(doc);
+	const TrigramIndex *index = pdoc->GetTrigramIndex();
+	if (!index)
+		return FALSE;
+	const TrigramQuery query(std::string_view(text, length), matchCase);
+	if (!query.usable)
+		return FALSE;
+
+	const Sci::Position end = pdoc->Length();
+	Sci::Position pos = 0;
+	while (pos < end) {
+		const Range run = index->Candidates(query, pos, end);
+		if (run.start >= end)
+			break;
+		const gintptr range[2] = { run.start, run.end };
+		g_array_append_vals(ranges, range, 1);
+		pos = run.end;
+	}
+	return TRUE;
+}
+
+/* Automaton matching every one of count NUL terminated terms in a single pass */
+void *scintilla_term_matcher_new(const char *const *terms, guint count, gboolean matchCase) {
+	try {
+		const std::vector<std::string_view> views(terms, terms + count);
+		return new AhoCorasick(views, matchCase);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void scintilla_term_matcher_free(void *matcher) {
+	delete static_cast<AhoCorasick *>(matcher);
+}
+
+/* Rescan [start, end) filling each match of term i with indicators[i] and value i + 1 */
+void scintilla_object_fill_terms(ScintillaObject *sci, void *matcher, const int *indicators, gintptr start, gintptr end) {
+	ScintillaGTK *psci = static_cast<ScintillaGTK *>(sci->pscin);
+	psci->pdoc->DecorationFillTerms(*static_cast<AhoCorasick *>(matcher), indicators, start, end);
+}
+
+static LexerPool &SharedLexerPool() {
+	// Never destroyed as documents may release their lexers during exit
+	static LexerPool *pool = new LexerPool(4);
+	return *pool;
+}
+
+/* A lexer released earlier by a document using the configuration named key, still
+ * holding its keyword lists and properties, or NULL when there is none */
+void *scintilla_lexer_pool_take(const char *key) {
+	try {
+		return SharedLexerPool().Take(key);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+/* Wrap a new lexer so that it returns to the pool under key when its document releases it */
+void *scintilla_lexer_pool_wrap(const char *key, void *lexer) {
+	try {
+		return SharedLexerPool().Wrap(key, static_cast<ILexer5 *>(lexer));
+	} catch (...) {
+		return lexer;
+	}
+}
+
+/* Apply a whole style table with a single style refresh */
+void scintilla_object_apply_styles(ScintillaObject *sci, const ScintillaStyleDef *styles, int count, const ScintillaElementColour *elements, int elementCount) {
+	ScintillaGTK *psci = static_cast<ScintillaGTK *>(sci->pscin);
+	psci->ApplyStyles(styles, count, elements, elementCount);
+}
+
+/* Time spent drawing the text area since the last reset */
+void scintilla_object_get_frame_stats(ScintillaObject *sci, ScintillaFrameStats *stats) {
+	const ScintillaGTK *psci = static_cast<ScintillaGTK *>(sci->pscin);
+	psci->FrameStats(stats);
+}
+
+void scintilla_object_reset_frame_stats(ScintillaObject *sci) {
+	ScintillaGTK *psci = static_cast<ScintillaGTK *>(sci->pscin);
+	psci->ResetFrameStats();
+}
+
+/* Seconds per byte measured for styling and wrapping, used to tune idle work */
+void scintilla_object_get_action_durations(ScintillaObject *sci, double *styleOneByte, double *wrapOneByte) {
+	const ScintillaGTK *psci = static_cast<ScintillaGTK *>(sci->pscin);
+	psci->ActionDurations(styleOneByte, wrapOneByte);
+}
+
 static void scintilla_class_init(ScintillaClass *klass);
 static void scintilla_init(ScintillaObject *sci);
 
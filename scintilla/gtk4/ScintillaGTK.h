@@ -73,9 +73,21 @@ class ScintillaGTK : public ScintillaBase {
 	FontOptions fontOptionsPrevious;
 	int accessibilityEnabled;
 
-	guint drawTimer = 0;
+	guint drawTick = 0;
 	bool needDraw = false;
 
+	// Render node recorded for each display line on screen starting at lineNodesTop,
+	// null when the line must be painted again
+	std::vector<GskRenderNode *> lineNodes;
+	Sci::Line lineNodesTop = 0;
+	int lineNodesWidth = 0;
+	int lineNodesHeight = 0;
+	// rows being painted by RecordLines, empty otherwise
+	size_t recordingFirst = 0;
+	size_t recordingLast = 0;
+	bool recordingInvalidated = false;
+	ScintillaFrameStats frameStats {};
+
 public:
 	explicit ScintillaGTK(_ScintillaObject *sci_);
 	// Deleted so ScintillaGTK objects can not be copied.
@@ -100,6 +112,10 @@ private:
 	std::string EncodedFromUTF8(std::string_view utf8) const override;
 public: 	// Public for scintilla_send_message
 	sptr_t WndProc(Scintilla::Message iMessage, Scintilla::uptr_t wParam, Scintilla::sptr_t lParam) override;
+	void ApplyStyles(const ScintillaStyleDef *styles, int count, const ScintillaElementColour *elements, int elementCount);
+	void ActionDurations(double *styleOneByte, double *wrapOneByte) const noexcept;
+	void FrameStats(ScintillaFrameStats *stats) const noexcept;
+	void ResetFrameStats() noexcept;
 private:
 	sptr_t DefWndProc(Scintilla::Message iMessage, Scintilla::uptr_t wParam, Scintilla::sptr_t lParam) override;
 	struct TimeThunk {
@@ -120,6 +136,8 @@ private:
 	void SetClientRectangle();
 	PRectangle GetClientRectangle() const override;
 	void ScrollText(Sci::Line linesToMove) override;
+	void Redraw() override;
+	void RedrawRect(PRectangle rc) override;
 	void SetVerticalScrollPos() override;
 	void SetHorizontalScrollPos() override;
 	bool ModifyScrollBars(Sci::Line nMax, Sci::Line nPage) override;
@@ -168,10 +186,18 @@ private:
 	static void GetPreferredHeight(GtkWidget *widget, gint *minimalHeight, gint *naturalHeight);
 	static void SizeAllocate(GtkWidget* widget, int width, int height, int baseline);
 	void CheckForFontOptionChange();
-	gboolean DrawTextThis(cairo_t *cr);
-	static gboolean DrawTextCb(GtkWidget *widget, cairo_t *cr, int width, int height, ScintillaGTK *sciThis);
+	void PaintText(cairo_t *cr);
+	void RecordLines(size_t first, size_t last, int width, int lineHeight, std::vector<GskRenderNode *> &nodes);
+	void SnapshotTextThis(GtkSnapshot *snapshot);
+	static void SnapshotText(GtkSnapshot *snapshot, void *data);
 	void DrawThis(GtkSnapshot* snapshot);
 	static void DrawMain(GtkWidget *widget, GtkSnapshot* snapshot);
+	void QueueTextDraw();
+	void ClearLineNodes(size_t first, size_t last) noexcept;
+	void DropLineNodes() noexcept;
+	void RebaseLineNodes(Sci::Line top) noexcept;
+	void CancelTextDraw() noexcept;
+	static gboolean DrawTick(GtkWidget *widget, GdkFrameClock *frameClock, gpointer data);
 
 	static void ScrollSignal(GtkAdjustment *adj, ScintillaGTK *sciThis);
 	static void ScrollHSignal(GtkAdjustment *adj, ScintillaGTK *sciThis);
@@ -35,6 +35,7 @@ struct GObjectReleaser {
 using UniquePangoContext = std::unique_ptr<PangoContext, GObjectReleaser>;
 using UniquePangoLayout = std::unique_ptr<PangoLayout, GObjectReleaser>;
 using UniquePangoFontMap = std::unique_ptr<PangoFontMap, GObjectReleaser>;
+using UniquePangoFont = std::unique_ptr<PangoFont, GObjectReleaser>;
 
 struct FontDescriptionReleaser {
 	void operator()(PangoFontDescription *fontDescription) noexcept {
@@ -61,6 +62,14 @@ struct LayoutIterReleaser {
 
 using UniquePangoLayoutIter = std::unique_ptr<PangoLayoutIter, LayoutIterReleaser>;
 
+struct GlyphStringReleaser {
+	void operator()(PangoGlyphString *glyphs) noexcept {
+		pango_glyph_string_free(glyphs);
+	}
+};
+
+using UniquePangoGlyphString = std::unique_ptr<PangoGlyphString, GlyphStringReleaser>;
+
 // Cairo
 
 struct CairoReleaser {
@@ -79,6 +88,14 @@ struct CairoSurfaceReleaser {
 
 using UniqueCairoSurface = std::unique_ptr<cairo_surface_t, CairoSurfaceReleaser>;
 
+struct CairoFontOptionsReleaser {
+	void operator()(cairo_font_options_t *options) noexcept {
+		cairo_font_options_destroy(options);
+	}
+};
+
+using UniqueCairoFontOptions = std::unique_ptr<cairo_font_options_t, CairoFontOptionsReleaser>;
+
 // GTK
 
 using UniqueIMContext = std::unique_ptr<GtkIMContext, GObjectReleaser>;
@@ -45,6 +45,9 @@ ScintillaGTK.o: \
 	../src/Decoration.h \
 	../src/CaseFolder.h \
 	../src/Document.h \
+	../src/TrigramIndex.h \
+	../src/AhoCorasick.h \
+	../src/LexerPool.h \
 	../src/CaseConvert.h \
 	../src/UniConversion.h \
 	../src/Selection.h \
@@ -59,6 +62,17 @@ ScintillaGTK.o: \
 	ScintillaGTK.h \
 	scintilla-marshal.h \
 	Converter.h
+AhoCorasick.o: \
+	../src/AhoCorasick.cxx \
+	../include/ScintillaTypes.h \
+	../src/Debugging.h \
+	../src/CharacterType.h \
+	../src/Position.h \
+	../src/SplitVector.h \
+	../src/Partitioning.h \
+	../src/RunStyles.h \
+	../src/CellBuffer.h \
+	../src/AhoCorasick.h
 AutoComplete.o: \
 	../src/AutoComplete.cxx \
 	../include/ScintillaTypes.h \
@@ -162,6 +176,9 @@ Document.o: \
 	../src/CaseFolder.h \
 	../src/Document.h \
 	../src/RESearch.h \
+	../src/LinearRegex.h \
+	../src/TrigramIndex.h \
+	../src/AhoCorasick.h \
 	../src/UniConversion.h \
 	../src/ElapsedPeriod.h
 EditModel.o: \
@@ -288,6 +305,26 @@ KeyMap.o: \
 	../src/Geometry.h \
 	../src/Platform.h \
 	../src/KeyMap.h
+LexerPool.o: \
+	../src/LexerPool.cxx \
+	../include/ILexer.h \
+	../src/LexerPool.h
+LinearRegex.o: \
+	../src/LinearRegex.cxx \
+	../include/ScintillaTypes.h \
+	../src/Debugging.h \
+	../src/CharacterType.h \
+	../src/CharacterCategoryMap.h \
+	../src/Position.h \
+	../src/SplitVector.h \
+	../src/Partitioning.h \
+	../src/RunStyles.h \
+	../src/CellBuffer.h \
+	../src/CharClassify.h \
+	../src/CaseConvert.h \
+	../src/UniConversion.h \
+	../src/DBCS.h \
+	../src/LinearRegex.h
 LineMarker.o: \
 	../src/LineMarker.cxx \
 	../include/ScintillaTypes.h \
@@ -435,6 +472,26 @@ Style.o: \
 	../src/Geometry.h \
 	../src/Platform.h \
 	../src/Style.h
+TrigramIndex.o: \
+	../src/TrigramIndex.cxx \
+	../include/ScintillaTypes.h \
+	../include/ILoader.h \
+	../include/Sci_Position.h \
+	../include/ILexer.h \
+	../src/Debugging.h \
+	../src/CharacterType.h \
+	../src/CharacterCategoryMap.h \
+	../src/Position.h \
+	../src/SplitVector.h \
+	../src/Partitioning.h \
+	../src/RunStyles.h \
+	../src/CellBuffer.h \
+	../src/CharClassify.h \
+	../src/Decoration.h \
+	../src/CaseFolder.h \
+	../src/Document.h \
+	../src/TrigramIndex.h \
+	../src/UniConversion.h
 UndoHistory.o: \
 	../src/UndoHistory.cxx \
 	../include/ScintillaTypes.h \
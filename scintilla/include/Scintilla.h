@@ -522,6 +522,7 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCFIND_REGEXP 0x00200000
 #define SCFIND_POSIX 0x00400000
 #define SCFIND_CXX11REGEX 0x00800000
+#define SCFIND_LINEARREGEX 0x01000000
 #define SCI_FINDTEXT 2150
 #define SCI_FINDTEXTFULL 2196
 #define SCI_FORMATRANGE 2151
@@ -290,6 +290,7 @@ enum class FindOption {
 	RegExp = 0x00200000,
 	Posix = 0x00400000,
 	Cxx11RegEx = 0x00800000,
+	LinearRegEx = 0x01000000,
 };
 
 enum class ChangeHistoryOption {
@@ -49,6 +49,43 @@ struct _ScintillaClass {
 	void (* notify) (ScintillaObject *sci, int id, SCNotification *scn);
 };
 
+/* One style of a table applied with scintilla_object_apply_styles, size in points
+ * and a NULL font keeping the style's current font */
+typedef struct {
+	const char *font;
+	guint32 fore;
+	guint32 back;
+	int size;
+	gboolean bold;
+	gboolean italic;
+	gboolean underline;
+} ScintillaStyleDef;
+
+typedef struct {
+	int element;
+	guint32 colour;
+} ScintillaElementColour;
+
+/* Text area drawing since the last reset, times in microseconds, scrolled frames
+ * reused the lines still in view and only painted the lines scrolled into view,
+ * recorded lines counts the display lines painted again */
+typedef struct {
+	guint64 frames;
+	guint64 scrolledFrames;
+	gint64 totalTime;
+	gint64 maxTime;
+	guint64 recordedLines;
+} ScintillaFrameStats;
+
+/* Shaped text kept for drawing by all widgets, size and budget in approximate bytes */
+typedef struct {
+	guint64 hits;
+	guint64 misses;
+	gsize entries;
+	gsize size;
+	gsize budget;
+} ScintillaGlyphCacheStats;
+
 SCI_EXTERN
 GType		scintilla_object_get_type		(void);
 
@@ -58,6 +95,90 @@ GtkWidget*	scintilla_object_new			(void);
 SCI_EXTERN
 gintptr		scintilla_object_send_message	(ScintillaObject *sci, unsigned int iMessage, guintptr wParam, gintptr lParam);
 
+SCI_EXTERN
+int		scintilla_loader_add_data		(void *loader, const char *data, gintptr length);
+
+SCI_EXTERN
+void*		scintilla_loader_convert_to_document	(void *loader);
+
+SCI_EXTERN
+int		scintilla_loader_release		(void *loader);
+
+SCI_EXTERN
+void*		scintilla_document_new_mapped		(const char *path, GError **error);
+
+SCI_EXTERN
+void		scintilla_object_replace_indicator_ranges	(ScintillaObject *sci, int indicator, int value, const gintptr *ranges, gsize count);
+
+SCI_EXTERN
+void*		scintilla_document_pin_text		(void *doc);
+
+SCI_EXTERN
+gboolean	scintilla_document_text_pinned		(void *doc);
+
+SCI_EXTERN
+gboolean	scintilla_document_text_unchanged	(void *doc, void *pin);
+
+SCI_EXTERN
+void		scintilla_text_pin_release		(void *pin);
+
+SCI_EXTERN
+void*		scintilla_trigram_index_new		(void *doc, gsize budget, guint *blocks);
+
+SCI_EXTERN
+void		scintilla_trigram_index_build		(void *index, const char *before, gsize beforeLength, const char *after, gsize afterLength, guint first, guint last);
+
+SCI_EXTERN
+void		scintilla_trigram_index_free		(void *index);
+
+SCI_EXTERN
+void		scintilla_document_set_trigram_index	(void *doc, void *index);
+
+SCI_EXTERN
+gsize		scintilla_document_get_trigram_index_memory	(void *doc);
+
+SCI_EXTERN
+gboolean	scintilla_document_trigram_candidates	(void *doc, const char *text, gintptr length, gboolean matchCase, GArray *ranges);
+
+SCI_EXTERN
+void*		scintilla_term_matcher_new		(const char *const *terms, guint count, gboolean matchCase);
+
+SCI_EXTERN
+void		scintilla_term_matcher_free		(void *matcher);
+
+SCI_EXTERN
+void		scintilla_object_fill_terms		(ScintillaObject *sci, void *matcher, const int *indicators, gintptr start, gintptr end);
+
+SCI_EXTERN
+void*		scintilla_lexer_pool_take		(const char *key);
+
+SCI_EXTERN
+void*		scintilla_lexer_pool_wrap		(const char *key, void *lexer);
+
+SCI_EXTERN
+void		scintilla_object_apply_styles	(ScintillaObject *sci, const ScintillaStyleDef *styles, int count, const ScintillaElementColour *elements, int elementCount);
+
+SCI_EXTERN
+void		scintilla_object_get_frame_stats	(ScintillaObject *sci, ScintillaFrameStats *stats);
+
+SCI_EXTERN
+void		scintilla_object_reset_frame_stats	(ScintillaObject *sci);
+
+SCI_EXTERN
+void		scintilla_object_get_action_durations	(ScintillaObject *sci, double *styleOneByte, double *wrapOneByte);
+
+SCI_EXTERN
+void		scintilla_glyph_cache_get_stats		(ScintillaGlyphCacheStats *stats);
+
+SCI_EXTERN
+void		scintilla_glyph_cache_reset_stats	(void);
+
+SCI_EXTERN
+void		scintilla_glyph_cache_set_budget	(gsize budget);
+
+SCI_EXTERN
+void		scintilla_measuring_pool_set_size	(gsize size);
+
 SCI_EXTERN
 GType		scnotification_get_type			(void);
 #define SCINTILLA_TYPE_NOTIFICATION        (scnotification_get_type())
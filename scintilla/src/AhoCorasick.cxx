@@ -0,0 +1,127 @@
+// Scintilla source code edit control
+/** @file AhoCorasick.cxx
+ ** Finds every occurrence of a set of terms in one pass over the text.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <memory>
+
+#include "ScintillaTypes.h"
+
+#include "Debugging.h"
+
+#include "CharacterType.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "AhoCorasick.h"
+
+using namespace Scintilla;
+using namespace Scintilla::Internal;
+
+AhoCorasick::AhoCorasick(const std::vector<std::string_view> &terms, bool caseSensitive) {
+	// Class 0 is every byte no term contains and always leads back to the root
+	for (const std::string_view text : terms) {
+		for (const unsigned char ch : text) {
+			const unsigned char folded = caseSensitive ? ch : MakeLowerCase(ch);
+			if (!byteClass[folded]) {
+				byteClass[folded] = static_cast<unsigned char>(classes++);
+			}
+		}
+	}
+	if (!caseSensitive) {
+		for (int ch = 'A'; ch <= 'Z'; ch++) {
+			byteClass[ch] = byteClass[MakeLowerCase(ch)];
+		}
+	}
+
+	AddState();
+	for (size_t index = 0; index < terms.size(); index++) {
+		const std::string_view text = terms[index];
+		lengths.push_back(text.length());
+		if (text.empty()) {
+			continue;
+		}
+		int state = 0;
+		for (const char ch : text) {
+			const size_t transition = state * classes + byteClass[static_cast<unsigned char>(ch)];
+			if (next[transition] < 0) {
+				const int added = AddState();
+				next[transition] = added;
+			}
+			state = next[transition];
+		}
+		if (term[state] < 0) {
+			term[state] = static_cast<int>(index);
+		}
+	}
+
+	// Breadth first so each state's failure state is complete before it is used
+	std::vector<int> failure(term.size());
+	std::vector<int> queue;
+	for (size_t cls = 0; cls < classes; cls++) {
+		int &target = next[cls];
+		if (target < 0) {
+			target = 0;
+		} else {
+			queue.push_back(target);
+		}
+	}
+	for (size_t head = 0; head < queue.size(); head++) {
+		const int state = queue[head];
+		const int fail = failure[state];
+		output[state] = (term[fail] >= 0) ? fail : output[fail];
+		for (size_t cls = 0; cls < classes; cls++) {
+			int &target = next[state * classes + cls];
+			const int fallback = next[fail * classes + cls];
+			if (target < 0) {
+				target = fallback;
+			} else {
+				failure[target] = fallback;
+				queue.push_back(target);
+			}
+		}
+	}
+}
+
+int AhoCorasick::AddState() {
+	const int state = static_cast<int>(term.size());
+	next.insert(next.end(), classes, -1);
+	term.push_back(-1);
+	output.push_back(-1);
+	return state;
+}
+
+size_t AhoCorasick::Terms() const noexcept {
+	return lengths.size();
+}
+
+void AhoCorasick::Scan(const SplitView &text, Sci::Position start, Sci::Position end, std::vector<Match> &matches) const {
+	end = std::min<Sci::Position>(end, text.length);
+	int state = 0;
+	// Each half of the gap buffer is walked directly
+	const auto scan = [&](const char *segment, Sci::Position from, Sci::Position to) {
+		for (Sci::Position position = from; position < to; position++) {
+			state = next[state * classes + byteClass[static_cast<unsigned char>(segment[position])]];
+			for (int found = (term[state] >= 0) ? state : output[state]; found >= 0; found = output[found]) {
+				const size_t index = term[found];
+				matches.push_back({ index, position + 1 - lengths[index], position + 1 });
+			}
+		}
+	};
+	const Sci::Position split = static_cast<Sci::Position>(text.length1);
+	scan(text.segment1, start, std::min(end, split));
+	scan(text.segment2, std::max(start, split), end);
+}
@@ -0,0 +1,48 @@
+// Scintilla source code edit control
+/** @file AhoCorasick.h
+ ** Finds every occurrence of a set of terms in one pass over the text.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef AHOCORASICK_H
+#define AHOCORASICK_H
+
+namespace Scintilla::Internal {
+
+/**
+ * Aho-Corasick automaton compiled to a DFA over byte classes so scanning costs
+ * one table lookup per byte whatever the number of terms.
+ * Only the bytes used by the terms get their own class which keeps the table small.
+ * Case insensitive matching folds ASCII letters only.
+ */
+class AhoCorasick {
+public:
+	struct Match {
+		size_t term;
+		Sci::Position start;
+		Sci::Position end;
+	};
+
+	/// Empty terms never match. A repeated term only reports its first index.
+	AhoCorasick(const std::vector<std::string_view> &terms, bool caseSensitive);
+
+	size_t Terms() const noexcept;
+
+	/// Append every match, overlapping ones included, lying within [start, end).
+	void Scan(const SplitView &text, Sci::Position start, Sci::Position end, std::vector<Match> &matches) const;
+
+private:
+	std::array<unsigned char, 256> byteClass {};
+	size_t classes = 1;
+	std::vector<int> next;
+	// Per state: the term ending there or -1, and the nearest suffix state with a term or -1
+	std::vector<int> term;
+	std::vector<int> output;
+	std::vector<Sci::Position> lengths;
+
+	int AddState();
+};
+
+}
+
+#endif
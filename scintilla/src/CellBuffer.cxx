@@ -331,6 +331,88 @@ public:
 	}
 };
 
+PinnableText::~PinnableText() noexcept {
+	Release();
+}
+
+// Hand the storage to the readers without copying, this object is left empty
+void PinnableText::Release() noexcept {
+	std::shared_ptr<PinnedText> holder = pin.lock();
+	if (holder) {
+		holder->body = std::move(body);
+		pin.reset();
+	}
+}
+
+// Copy the text, with room for capacity elements, before the pinned storage would change
+void PinnableText::Detach(size_t capacity) {
+	std::shared_ptr<PinnedText> holder = pin.lock();
+	if (!holder) {
+		return;
+	}
+	std::vector<char> copy;
+	copy.reserve(std::max(capacity, body.size()));
+	copy.assign(body.begin(), body.end());
+	// Moving the vector keeps its allocation so the readers' pointers stay valid
+	holder->body = std::move(body);
+	body = std::move(copy);
+	pin.reset();
+}
+
+std::shared_ptr<PinnedText> PinnableText::Pin() {
+	std::shared_ptr<PinnedText> holder = pin.lock();
+	if (!holder) {
+		holder = std::make_shared<PinnedText>();
+		pin = holder;
+	}
+	return holder;
+}
+
+bool PinnableText::Pinned() const noexcept {
+	return !pin.expired();
+}
+
+bool PinnableText::IsPin(const PinnedText *pinned) const noexcept {
+	return pin.lock().get() == pinned;
+}
+
+void PinnableText::ReAllocate(size_t newSize) {
+	if (newSize > body.size()) {
+		Detach(newSize);
+	}
+	SplitVector<char>::ReAllocate(newSize);
+}
+
+void PinnableText::InsertFromArray(ptrdiff_t positionToInsert, const char s[], ptrdiff_t positionFrom, ptrdiff_t insertLength) {
+	if (insertLength > 0) {
+		Detach(body.size() + insertLength + GetGrowSize());
+	}
+	SplitVector<char>::InsertFromArray(positionToInsert, s, positionFrom, insertLength);
+}
+
+void PinnableText::DeleteRange(ptrdiff_t position, ptrdiff_t deleteLength) {
+	if ((position == 0) && (deleteLength == lengthBody)) {
+		// Everything goes so the storage can be handed over as it is
+		Release();
+	} else if (deleteLength > 0) {
+		Detach(0);
+	}
+	SplitVector<char>::DeleteRange(position, deleteLength);
+}
+
+char *PinnableText::BufferPointer() {
+	Detach(body.size() + 1);
+	return SplitVector<char>::BufferPointer();
+}
+
+char *PinnableText::RangePointer(ptrdiff_t position, ptrdiff_t rangeLength) {
+	if (position < part1Length && (position + rangeLength) > part1Length) {
+		// The gap is moved
+		Detach(0);
+	}
+	return SplitVector<char>::RangePointer(position, rangeLength);
+}
+
 CellBuffer::CellBuffer(bool hasStyles_, bool largeDocument_) :
 	hasStyles(hasStyles_), largeDocument(largeDocument_) {
 	readOnly = false;
@@ -346,12 +428,22 @@ CellBuffer::CellBuffer(bool hasStyles_, bool largeDocument_) :
 
 CellBuffer::~CellBuffer() noexcept = default;
 
-char CellBuffer::CharAt(Sci::Position position) const noexcept {
+char CellBuffer::SubstanceAt(Sci::Position position) const noexcept {
+	if (mapped) {
+		if (position < 0 || position >= mappedLength) {
+			return 0;
+		}
+		return mapped.get()[position];
+	}
 	return substance.ValueAt(position);
 }
 
+char CellBuffer::CharAt(Sci::Position position) const noexcept {
+	return SubstanceAt(position);
+}
+
 unsigned char CellBuffer::UCharAt(Sci::Position position) const noexcept {
-	return substance.ValueAt(position);
+	return SubstanceAt(position);
 }
 
 void CellBuffer::GetCharRange(char *buffer, Sci::Position position, Sci::Position lengthRetrieve) const {
@@ -359,11 +451,15 @@ void CellBuffer::GetCharRange(char *buffer, Sci::Position position, Sci::Positio
 		return;
 	if (position < 0)
 		return;
-	if ((position + lengthRetrieve) > substance.Length()) {
+	if ((position + lengthRetrieve) > Length()) {
 		Platform::DebugPrintf("Bad GetCharRange %.0f for %.0f of %.0f\n",
 				      static_cast<double>(position),
 				      static_cast<double>(lengthRetrieve),
-				      static_cast<double>(substance.Length()));
+				      static_cast<double>(Length()));
+		return;
+	}
+	if (mapped) {
+		memcpy(buffer, mapped.get() + position, lengthRetrieve);
 		return;
 	}
 	substance.GetRange(buffer, position, lengthRetrieve);
@@ -382,6 +478,13 @@ void CellBuffer::GetStyleRange(unsigned char *buffer, Sci::Position position, Sc
 		std::fill(buffer, buffer + lengthRetrieve, static_cast<unsigned char>(0));
 		return;
 	}
+	if (mapped && (position + lengthRetrieve) > style.Length() && (position + lengthRetrieve) <= Length()) {
+		// Mapped text is only styled up to where styling has reached, the rest is default
+		const Sci::Position lengthStored = std::clamp<Sci::Position>(style.Length() - position, 0, lengthRetrieve);
+		style.GetRange(reinterpret_cast<char *>(buffer), position, lengthStored);
+		std::fill(buffer + lengthStored, buffer + lengthRetrieve, static_cast<unsigned char>(0));
+		return;
+	}
 	if ((position + lengthRetrieve) > style.Length()) {
 		Platform::DebugPrintf("Bad GetStyleRange %.0f for %.0f of %.0f\n",
 				      static_cast<double>(position),
@@ -393,18 +496,32 @@ void CellBuffer::GetStyleRange(unsigned char *buffer, Sci::Position position, Sc
 }
 
 const char *CellBuffer::BufferPointer() {
+	if (mapped) {
+		return mapped.get();
+	}
 	return substance.BufferPointer();
 }
 
-const char *CellBuffer::RangePointer(Sci::Position position, Sci::Position rangeLength) noexcept {
+const char *CellBuffer::RangePointer(Sci::Position position, Sci::Position rangeLength) {
+	if (mapped) {
+		return mapped.get() + position;
+	}
 	return substance.RangePointer(position, rangeLength);
 }
 
 Sci::Position CellBuffer::GapPosition() const noexcept {
+	if (mapped) {
+		return mappedLength;
+	}
 	return substance.GapPosition();
 }
 
 SplitView CellBuffer::AllView() const noexcept {
+	if (mapped) {
+		// Mapped text is contiguous so both segments are the mapping
+		const size_t length = mappedLength;
+		return SplitView { mapped.get(), length, mapped.get(), length };
+	}
 	const size_t length = substance.Length();
 	size_t length1 = substance.GapPosition();
 	if (length1 == 0) {
@@ -419,6 +536,30 @@ SplitView CellBuffer::AllView() const noexcept {
 	};
 }
 
+// Readers on other threads may hold pointers into the text for as long as they like without
+// blocking edits, the document moves to a copy of its text when it is next changed.
+std::shared_ptr<PinnedText> CellBuffer::PinText() {
+	if (mapped) {
+		// Mapped text never changes, it only has to outlive the document
+		std::shared_ptr<PinnedText> pinned = std::make_shared<PinnedText>();
+		pinned->mapped = mapped;
+		return pinned;
+	}
+	return substance.Pin();
+}
+
+// Whether a change now would have to copy the text first
+bool CellBuffer::TextPinned() const noexcept {
+	return !mapped && substance.Pinned();
+}
+
+bool CellBuffer::TextUnchangedSince(const PinnedText &pinned) const noexcept {
+	if (mapped) {
+		return pinned.mapped == mapped;
+	}
+	return substance.IsPin(&pinned);
+}
+
 // The char* returned is to an allocation owned by the undo history
 const char *CellBuffer::InsertString(Sci::Position position, const char *s, Sci::Position insertLength, bool &startSequence) {
 	// InsertString and DeleteChars are the bottleneck though which all changes occur
@@ -438,10 +579,26 @@ const char *CellBuffer::InsertString(Sci::Position position, const char *s, Sci:
 	return data;
 }
 
+bool CellBuffer::EnsureMappedStyles(Sci::Position end) noexcept {
+	// Styles of mapped text are allocated lazily as styling proceeds through the document
+	end = std::min(end, mappedLength);
+	try {
+		style.EnsureLength(end);
+	} catch (...) {
+		return false;
+	}
+	return true;
+}
+
 bool CellBuffer::SetStyleAt(Sci::Position position, char styleValue) noexcept {
 	if (!hasStyles) {
 		return false;
 	}
+	if (mapped && position >= style.Length()) {
+		if (styleValue == 0 || !EnsureMappedStyles(position + 1)) {
+			return false;
+		}
+	}
 	const char curVal = style.ValueAt(position);
 	if (curVal != styleValue) {
 		style.SetValueAt(position, styleValue);
@@ -455,6 +612,14 @@ bool CellBuffer::SetStyleFor(Sci::Position position, Sci::Position lengthStyle,
 	if (!hasStyles) {
 		return false;
 	}
+	if (mapped && (position + lengthStyle) > style.Length()) {
+		if (styleValue == 0) {
+			// Unallocated styles are already 0
+			lengthStyle = std::max<Sci::Position>(style.Length() - position, 0);
+		} else if (!EnsureMappedStyles(position + lengthStyle)) {
+			return false;
+		}
+	}
 	bool changed = false;
 	PLATFORM_ASSERT(lengthStyle == 0 ||
 		(lengthStyle > 0 && lengthStyle + position <= style.Length()));
@@ -493,10 +658,16 @@ const char *CellBuffer::DeleteChars(Sci::Position position, Sci::Position delete
 }
 
 Sci::Position CellBuffer::Length() const noexcept {
+	if (mapped) {
+		return mappedLength;
+	}
 	return substance.Length();
 }
 
 void CellBuffer::Allocate(Sci::Position newSize) {
+	if (mapped) {
+		return;
+	}
 	if (!largeDocument && (newSize > INT32_MAX)) {
 		throw std::runtime_error("CellBuffer::Allocate: size of standard document limited to 2G.");
 	}
@@ -506,6 +677,24 @@ void CellBuffer::Allocate(Sci::Position newSize) {
 	}
 }
 
+// Replace the empty substance with text that is owned elsewhere and can not be modified.
+// Line starts are found here but styles are only allocated when styling reaches them.
+void CellBuffer::SetMappedSubstance(std::shared_ptr<const char> text, Sci::Position length) {
+	if (!largeDocument && (length > INT32_MAX)) {
+		throw std::runtime_error("CellBuffer::SetMappedSubstance: size of standard document limited to 2G.");
+	}
+	PLATFORM_ASSERT(substance.Length() == 0);
+	mapped = std::move(text);
+	mappedLength = length;
+	readOnly = true;
+	collectingUndo = false;
+	ResetLineEnds();
+}
+
+bool CellBuffer::IsMapped() const noexcept {
+	return static_cast<bool>(mapped);
+}
+
 void CellBuffer::SetUTF8Substance(bool utf8Substance_) noexcept {
 	utf8Substance = utf8Substance_;
 }
@@ -619,7 +808,8 @@ bool CellBuffer::IsReadOnly() const noexcept {
 }
 
 void CellBuffer::SetReadOnly(bool set) noexcept {
-	readOnly = set;
+	// Mapped text can never be modified
+	readOnly = set || mapped;
 }
 
 bool CellBuffer::IsLarge() const noexcept {
@@ -722,7 +912,7 @@ void CellBuffer::ResetLineEnds() {
 	unsigned char chBeforePrev = 0;
 	unsigned char chPrev = 0;
 	for (Sci::Position i = 0; i < length; i++) {
-		const unsigned char ch = substance.ValueAt(position + i);
+		const unsigned char ch = SubstanceAt(position + i);
 		if (ch == '\r') {
 			InsertLine(lineInsert, (position + i) + 1, atLineStart);
 			lineInsert++;
@@ -66,6 +66,46 @@ struct SplitView {
 	}
 };
 
+/**
+ * Text storage kept for readers by CellBuffer::PinText. Pointers into the text taken while
+ * it is pinned stay valid and unchanged for as long as the readers hold it.
+ */
+struct PinnedText {
+	std::vector<char> body;	///< The storage left behind once the document changes
+	std::shared_ptr<const char> mapped;
+};
+
+/**
+ * Substance that can be pinned: the first change after pinning moves the text to a copy
+ * and leaves the pinned storage to the readers, so they never see it change.
+ */
+class PinnableText : private SplitVector<char> {
+	std::weak_ptr<PinnedText> pin;
+	void Detach(size_t capacity);
+	void Release() noexcept;
+public:
+	PinnableText() = default;
+	PinnableText(const PinnableText &) = delete;
+	PinnableText(PinnableText &&) = delete;
+	PinnableText &operator=(const PinnableText &) = delete;
+	PinnableText &operator=(PinnableText &&) = delete;
+	~PinnableText() noexcept;
+
+	using SplitVector<char>::ValueAt;
+	using SplitVector<char>::Length;
+	using SplitVector<char>::GetRange;
+	using SplitVector<char>::ElementPointer;
+	using SplitVector<char>::GapPosition;
+
+	std::shared_ptr<PinnedText> Pin();
+	bool Pinned() const noexcept;
+	bool IsPin(const PinnedText *pinned) const noexcept;
+	void ReAllocate(size_t newSize);
+	void InsertFromArray(ptrdiff_t positionToInsert, const char s[], ptrdiff_t positionFrom, ptrdiff_t insertLength);
+	void DeleteRange(ptrdiff_t position, ptrdiff_t deleteLength);
+	char *BufferPointer();
+	char *RangePointer(ptrdiff_t position, ptrdiff_t rangeLength);
+};
 
 /**
  * Holder for an expandable array of characters that supports undo and line markers.
@@ -76,8 +116,11 @@ class CellBuffer {
 private:
 	bool hasStyles;
 	bool largeDocument;
-	SplitVector<char> substance;
+	PinnableText substance;
 	SplitVector<char> style;
+	/// Read-only text borrowed from outside, such as a file mapping, used instead of substance
+	std::shared_ptr<const char> mapped;
+	Sci::Position mappedLength = 0;
 	bool readOnly;
 	bool utf8Substance;
 	Scintilla::LineEndType utf8LineEnds;
@@ -89,6 +132,8 @@ private:
 
 	std::unique_ptr<ILineVector> plv;
 
+	char SubstanceAt(Sci::Position position) const noexcept;
+	bool EnsureMappedStyles(Sci::Position end) noexcept;
 	bool UTF8LineEndOverlaps(Sci::Position position) const noexcept;
 	bool UTF8IsCharacterBoundary(Sci::Position position) const;
 	void ResetLineEnds();
@@ -115,12 +160,17 @@ public:
 	char StyleAt(Sci::Position position) const noexcept;
 	void GetStyleRange(unsigned char *buffer, Sci::Position position, Sci::Position lengthRetrieve) const;
 	const char *BufferPointer();
-	const char *RangePointer(Sci::Position position, Sci::Position rangeLength) noexcept;
+	const char *RangePointer(Sci::Position position, Sci::Position rangeLength);
 	Sci::Position GapPosition() const noexcept;
 	SplitView AllView() const noexcept;
+	std::shared_ptr<PinnedText> PinText();
+	bool TextPinned() const noexcept;
+	bool TextUnchangedSince(const PinnedText &pinned) const noexcept;
 
 	Sci::Position Length() const noexcept;
 	void Allocate(Sci::Position newSize);
+	void SetMappedSubstance(std::shared_ptr<const char> text, Sci::Position length);
+	bool IsMapped() const noexcept;
 	void SetUTF8Substance(bool utf8Substance_) noexcept;
 	Scintilla::LineEndType GetLineEndTypes() const noexcept { return utf8LineEnds; }
 	void SetLineEndTypes(Scintilla::LineEndType utf8LineEnds_);
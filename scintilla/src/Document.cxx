@@ -27,6 +27,17 @@
 #include <regex>
 #endif
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SCI_SEARCH_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define SCI_SEARCH_SSE2
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #include "ScintillaTypes.h"
 #include "ILoader.h"
 #include "ILexer.h"
@@ -46,6 +57,9 @@
 #include "CaseFolder.h"
 #include "Document.h"
 #include "RESearch.h"
+#include "LinearRegex.h"
+#include "TrigramIndex.h"
+#include "AhoCorasick.h"
 #include "UniConversion.h"
 #include "ElapsedPeriod.h"
 
@@ -1406,6 +1420,17 @@ int SCI_METHOD Document::AddData(const char *data, Sci_Position length) {
 	return static_cast<int>(Status::Ok);
 }
 
+// Use read-only text owned elsewhere, such as a file mapping, as the whole of an empty document.
+void Document::SetMappedText(std::shared_ptr<const char> text, Sci::Position length) {
+	const Sci::Line prevLinesTotal = LinesTotal();
+	cb.SetMappedSubstance(std::move(text), length);
+	NotifyModified(
+		DocModification(
+			ModificationFlags::InsertText,
+			0, length,
+			LinesTotal() - prevLinesTotal, nullptr));
+}
+
 IDocumentEditable *Document::AsDocumentEditable() noexcept {
 	return static_cast<IDocumentEditable *>(this);
 }
@@ -2094,6 +2119,25 @@ void Document::SetCaseFolder(std::unique_ptr<CaseFolder> pcf_) noexcept {
 	pcf = std::move(pcf_);
 }
 
+TrigramIndex *Document::GetTrigramIndex() const noexcept {
+	return trigramIndex.get();
+}
+
+// An index is about to be built from a copy of the current text, edits are recorded from now on
+void Document::StartTrigramBuild() {
+	trigramIndex.reset();
+	trigramEdits = std::make_unique<std::vector<TrigramEdit>>();
+}
+
+void Document::SetTrigramIndex(std::unique_ptr<TrigramIndex> trigramIndex_) {
+	std::unique_ptr<std::vector<TrigramEdit>> edits = std::move(trigramEdits);
+	trigramIndex.reset();
+	if (trigramIndex_ && edits) {
+		trigramIndex_->Replay(cb.AllView(), *edits);
+	}
+	trigramIndex = std::move(trigramIndex_);
+}
+
 CharacterExtracted Document::ExtractCharacter(Sci::Position position) const noexcept {
 	const unsigned char leadByte = cb.UCharAt(position);
 	if (UTF8IsAscii(leadByte)) {
@@ -2109,20 +2153,138 @@ CharacterExtracted Document::ExtractCharacter(Sci::Position position) const noex
 
 namespace {
 
-// Equivalent of memchr over the split view
-ptrdiff_t SplitFindChar(const SplitView &view, size_t start, size_t length, int ch) noexcept {
-	size_t range1Length = 0;
-	if (start < view.length1) {
-		range1Length = std::min(length, view.length1 - start);
-		const char *match = static_cast<const char *>(memchr(view.segment1 + start, ch, range1Length));
-		if (match) {
-			return match - view.segment1;
+// Literal search over contiguous text.
+// Candidates are found a block at a time by comparing against the first and last bytes
+// of the needle, then the middle is compared.
+
+#if defined(SCI_SEARCH_AVX2)
+using SearchBlock = __m256i;
+constexpr size_t searchBlockSize = 32;
+SearchBlock LoadBlock(const char *p) noexcept {
+	return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+SearchBlock SplatBlock(char ch) noexcept {
+	return _mm256_set1_epi8(ch);
+}
+SearchBlock EqualBlock(SearchBlock a, SearchBlock b) noexcept {
+	return _mm256_cmpeq_epi8(a, b);
+}
+SearchBlock OrBlock(SearchBlock a, SearchBlock b) noexcept {
+	return _mm256_or_si256(a, b);
+}
+unsigned int HighBitMask(SearchBlock a) noexcept {
+	return _mm256_movemask_epi8(a);
+}
+#elif defined(SCI_SEARCH_SSE2)
+using SearchBlock = __m128i;
+constexpr size_t searchBlockSize = 16;
+SearchBlock LoadBlock(const char *p) noexcept {
+	return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+SearchBlock SplatBlock(char ch) noexcept {
+	return _mm_set1_epi8(ch);
+}
+SearchBlock EqualBlock(SearchBlock a, SearchBlock b) noexcept {
+	return _mm_cmpeq_epi8(a, b);
+}
+SearchBlock OrBlock(SearchBlock a, SearchBlock b) noexcept {
+	return _mm_or_si128(a, b);
+}
+unsigned int HighBitMask(SearchBlock a) noexcept {
+	return _mm_movemask_epi8(a);
+}
+#endif
+
+#if defined(SCI_SEARCH_AVX2) || defined(SCI_SEARCH_SSE2)
+unsigned int EqualMask(SearchBlock a, SearchBlock b) noexcept {
+	return HighBitMask(EqualBlock(a, b));
+}
+
+int LowestBit(unsigned int mask) noexcept {
+#if defined(_MSC_VER)
+	unsigned long index = 0;
+	_BitScanForward(&index, mask);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+// Find first start position in [from, to) of needle where text[to - 1 + needle.length() - 1] is readable.
+ptrdiff_t FindLiteral(const char *text, size_t from, size_t to, std::string_view needle) noexcept {
+	const size_t last = needle.length() - 1;
+	const char chFirst = needle.front();
+	const char chLast = needle.back();
+	size_t pos = from;
+#if defined(SCI_SEARCH_AVX2) || defined(SCI_SEARCH_SSE2)
+	const SearchBlock blockFirst = SplatBlock(chFirst);
+	const SearchBlock blockLast = SplatBlock(chLast);
+	for (; pos + searchBlockSize <= to; pos += searchBlockSize) {
+		// Most blocks hold no first byte so test four at a time
+		while (pos + 4 * searchBlockSize <= to) {
+			const SearchBlock any = OrBlock(
+				OrBlock(EqualBlock(LoadBlock(text + pos), blockFirst),
+					EqualBlock(LoadBlock(text + pos + searchBlockSize), blockFirst)),
+				OrBlock(EqualBlock(LoadBlock(text + pos + 2 * searchBlockSize), blockFirst),
+					EqualBlock(LoadBlock(text + pos + 3 * searchBlockSize), blockFirst)));
+			if (HighBitMask(any)) {
+				break;
+			}
+			pos += 4 * searchBlockSize;
+		}
+		if (pos + searchBlockSize > to) {
+			break;
+		}
+		unsigned int mask = EqualMask(LoadBlock(text + pos), blockFirst);
+		if (mask) {
+			mask &= EqualMask(LoadBlock(text + pos + last), blockLast);
+		}
+		while (mask) {
+			const size_t candidate = pos + LowestBit(mask);
+			if (last < 2 || memcmp(text + candidate + 1, needle.data() + 1, last - 1) == 0) {
+				return candidate;
+			}
+			mask &= mask - 1;
+		}
+	}
+#endif
+	while (pos < to) {
+		const char *match = static_cast<const char *>(memchr(text + pos, chFirst, to - pos));
+		if (!match) {
+			return -1;
+		}
+		pos = match - text;
+		if (text[pos + last] == chLast &&
+			(last < 2 || memcmp(text + pos + 1, needle.data() + 1, last - 1) == 0)) {
+			return pos;
+		}
+		pos++;
+	}
+	return -1;
+}
+
+// Find first position in [from, to) that may start a case insensitive match of a needle
+// starting with an ASCII character: either case of that character or any non-ASCII byte
+// as some non-ASCII characters fold to ASCII.
+ptrdiff_t FindFoldCandidate(const char *text, size_t from, size_t to, char lower, char upper) noexcept {
+	size_t pos = from;
+#if defined(SCI_SEARCH_AVX2) || defined(SCI_SEARCH_SSE2)
+	const SearchBlock blockLower = SplatBlock(lower);
+	const SearchBlock blockUpper = SplatBlock(upper);
+	for (; pos + searchBlockSize <= to; pos += searchBlockSize) {
+		const SearchBlock block = LoadBlock(text + pos);
+		const unsigned int mask = EqualMask(block, blockLower) | EqualMask(block, blockUpper) | HighBitMask(block);
+		if (mask) {
+			return pos + LowestBit(mask);
 		}
-		start += range1Length;
 	}
-	const char *match2 = static_cast<const char *>(memchr(view.segment2 + start, ch, length - range1Length));
-	if (match2) {
-		return match2 - view.segment2;
+#endif
+	for (; pos < to; pos++) {
+		const char ch = text[pos];
+		if (ch == lower || ch == upper || !UTF8IsAscii(ch)) {
+			return pos;
+		}
 	}
 	return -1;
 }
@@ -2139,6 +2301,71 @@ bool SplitMatch(const SplitView &view, size_t start, std::string_view text) noex
 	return true;
 }
 
+// Boyer-Moore-Horspool over the split view for the few positions where a match straddles the gap
+ptrdiff_t SplitFindHorspool(const SplitView &view, size_t from, size_t to, std::string_view needle) noexcept {
+	const size_t last = needle.length() - 1;
+	std::array<size_t, 256> shift;
+	shift.fill(needle.length());
+	for (size_t i = 0; i < last; i++) {
+		shift[static_cast<unsigned char>(needle[i])] = last - i;
+	}
+	size_t pos = from;
+	while (pos < to) {
+		const char ch = view.CharAt(pos + last);
+		if (ch == needle.back() && SplitMatch(view, pos, needle.substr(0, last))) {
+			return pos;
+		}
+		pos += shift[static_cast<unsigned char>(ch)];
+	}
+	return -1;
+}
+
+// Find first start position in [start, endSearch) of needle over the split view
+ptrdiff_t SplitFindLiteral(const SplitView &view, size_t start, size_t endSearch, std::string_view needle) noexcept {
+	if (needle.length() > view.length) {
+		return -1;
+	}
+	endSearch = std::min(endSearch, view.length - needle.length() + 1);
+	// Matches entirely before the gap
+	const size_t endBeforeGap = (view.length1 >= needle.length()) ? view.length1 - needle.length() + 1 : 0;
+	if (start < endBeforeGap) {
+		const ptrdiff_t match = FindLiteral(view.segment1, start, std::min(endSearch, endBeforeGap), needle);
+		if (match >= 0) {
+			return match;
+		}
+		start = endBeforeGap;
+	}
+	// Matches across the gap
+	if (start < std::min(endSearch, view.length1)) {
+		const ptrdiff_t match = SplitFindHorspool(view, start, std::min(endSearch, view.length1), needle);
+		if (match >= 0) {
+			return match;
+		}
+		start = view.length1;
+	}
+	// Matches entirely after the gap, segment2 is addressed with document positions
+	if (start < endSearch) {
+		return FindLiteral(view.segment2, start, endSearch, needle);
+	}
+	return -1;
+}
+
+// Equivalent of FindFoldCandidate over the split view
+ptrdiff_t SplitFindFoldCandidate(const SplitView &view, size_t start, size_t end, char lower, char upper) noexcept {
+	end = std::min(end, view.length);
+	if (start < view.length1) {
+		const ptrdiff_t match = FindFoldCandidate(view.segment1, start, std::min(end, view.length1), lower, upper);
+		if (match >= 0) {
+			return match;
+		}
+		start = view.length1;
+	}
+	if (start < end) {
+		return FindFoldCandidate(view.segment2, start, end, lower, upper);
+	}
+	return -1;
+}
+
 }
 
 /**
@@ -2151,214 +2378,286 @@ Sci::Position Document::FindText(Sci::Position minPos, Sci::Position maxPos, con
 	if (*length <= 0)
 		return minPos;
 	const bool caseSensitive = FlagSet(flags, FindOption::MatchCase);
-	const bool word = FlagSet(flags, FindOption::WholeWord);
-	const bool wordStart = FlagSet(flags, FindOption::WordStart);
 	const bool regExp = FlagSet(flags, FindOption::RegExp);
 	if (regExp) {
+		const bool word = FlagSet(flags, FindOption::WholeWord);
+		const bool wordStart = FlagSet(flags, FindOption::WordStart);
 		if (!regex)
 			regex = std::unique_ptr<RegexSearchBase>(CreateRegexSearch(&charClass));
 		return regex->FindText(this, minPos, maxPos, search, caseSensitive, word, wordStart, flags, length);
-	} else {
+	}
+	if (trigramIndex && (minPos < maxPos)) {
+		const TrigramQuery query(std::string_view(search, *length), caseSensitive);
+		if (query.usable) {
+			// Only runs of blocks that may hold the start of a match are searched. A match may
+			// extend past its run and case folding can make it longer than the search text.
+			const Sci::Position reach = *length * (caseSensitive ? 1 : UTF8MaxBytes);
+			Sci::Position pos = minPos;
+			while (pos < maxPos) {
+				const Range run = trigramIndex->Candidates(query, pos, maxPos);
+				if (run.start >= maxPos) {
+					break;
+				}
+				Sci::Position lengthFound = *length;
+				const Sci::Position posFound = FindLiteral(run.start, std::min(maxPos, run.end + reach), search, flags, &lengthFound);
+				if (posFound >= 0) {
+					*length = lengthFound;
+					return posFound;
+				}
+				pos = run.end;
+			}
+			return -1;
+		}
+	}
+	return FindLiteral(minPos, maxPos, search, flags, length);
+}
 
-		const bool forward = minPos <= maxPos;
-		const int increment = forward ? 1 : -1;
-
-		// Range endpoints should not be inside DBCS characters, but just in case, move them.
-		const Sci::Position startPos = MovePositionOutsideChar(minPos, increment, false);
-		const Sci::Position endPos = MovePositionOutsideChar(maxPos, increment, false);
-
-		// Compute actual search ranges needed
-		const Sci::Position lengthFind = *length;
-
-		//Platform::DebugPrintf("Find %d %d %s %d\n", startPos, endPos, ft->lpstrText, lengthFind);
-		const Sci::Position limitPos = std::max(startPos, endPos);
-		Sci::Position pos = startPos;
-		if (!forward) {
-			// Back all of a character
-			pos = NextPosition(pos, increment);
-		}
-		const SplitView cbView = cb.AllView();
-		if (caseSensitive) {
-			const Sci::Position endSearch = (startPos <= endPos) ? endPos - lengthFind + 1 : endPos;
-			const unsigned char charStartSearch =  search[0];
-			if (forward && ((0 == dbcsCodePage) || (CpUtf8 == dbcsCodePage && !UTF8IsTrailByte(charStartSearch)))) {
-				// This is a fast case where there is no need to test byte values to iterate
-				// so becomes the equivalent of a memchr+memcmp loop.
-				// UTF-8 search will not be self-synchronizing when starts with trail byte
-				const std::string_view suffix(search + 1, lengthFind - 1);
-				while (pos < endSearch) {
-					pos = SplitFindChar(cbView, pos, limitPos - pos, charStartSearch);
-					if (pos < 0) {
-						break;
+Sci::Position Document::FindLiteral(Sci::Position minPos, Sci::Position maxPos, const char *search,
+                        FindOption flags, Sci::Position *length) {
+	const bool caseSensitive = FlagSet(flags, FindOption::MatchCase);
+	const bool word = FlagSet(flags, FindOption::WholeWord);
+	const bool wordStart = FlagSet(flags, FindOption::WordStart);
+
+	const bool forward = minPos <= maxPos;
+	const int increment = forward ? 1 : -1;
+
+	// Range endpoints should not be inside DBCS characters, but just in case, move them.
+	const Sci::Position startPos = MovePositionOutsideChar(minPos, increment, false);
+	const Sci::Position endPos = MovePositionOutsideChar(maxPos, increment, false);
+
+	// Compute actual search ranges needed
+	const Sci::Position lengthFind = *length;
+
+	//Platform::DebugPrintf("Find %d %d %s %d\n", startPos, endPos, ft->lpstrText, lengthFind);
+	const Sci::Position limitPos = std::max(startPos, endPos);
+	Sci::Position pos = startPos;
+	if (!forward) {
+		// Back all of a character
+		pos = NextPosition(pos, increment);
+	}
+	const SplitView cbView = cb.AllView();
+	if (caseSensitive) {
+		const Sci::Position endSearch = (startPos <= endPos) ? endPos - lengthFind + 1 : endPos;
+		const unsigned char charStartSearch =  search[0];
+		if (forward && ((0 == dbcsCodePage) || (CpUtf8 == dbcsCodePage && !UTF8IsTrailByte(charStartSearch)))) {
+			// This is a fast case where there is no need to test byte values to iterate
+			// so becomes a vectorised search for first and last bytes then memcmp.
+			// UTF-8 search will not be self-synchronizing when starts with trail byte
+			const std::string_view needle(search, lengthFind);
+			while (pos < endSearch) {
+				pos = SplitFindLiteral(cbView, pos, endSearch, needle);
+				if (pos < 0) {
+					break;
+				}
+				if (MatchesWordOptions(word, wordStart, pos, lengthFind)) {
+					return pos;
+				}
+				pos++;
+			}
+		} else {
+			while (forward ? (pos < endSearch) : (pos >= endSearch)) {
+				const unsigned char leadByte = cbView.CharAt(pos);
+				if (leadByte == charStartSearch) {
+					bool found = (pos + lengthFind) <= limitPos;
+					// SplitMatch could be called here but it is slower with g++ -O2
+					for (int indexSearch = 1; (indexSearch < lengthFind) && found; indexSearch++) {
+						found = cbView.CharAt(pos + indexSearch) == search[indexSearch];
 					}
-					if (SplitMatch(cbView, pos + 1, suffix) && MatchesWordOptions(word, wordStart, pos, lengthFind)) {
+					if (found && MatchesWordOptions(word, wordStart, pos, lengthFind)) {
 						return pos;
 					}
-					pos++;
 				}
-			} else {
-				while (forward ? (pos < endSearch) : (pos >= endSearch)) {
-					const unsigned char leadByte = cbView.CharAt(pos);
-					if (leadByte == charStartSearch) {
-						bool found = (pos + lengthFind) <= limitPos;
-						// SplitMatch could be called here but it is slower with g++ -O2
-						for (int indexSearch = 1; (indexSearch < lengthFind) && found; indexSearch++) {
-							found = cbView.CharAt(pos + indexSearch) == search[indexSearch];
-						}
-						if (found && MatchesWordOptions(word, wordStart, pos, lengthFind)) {
-							return pos;
+				if (forward && UTF8IsAscii(leadByte)) {
+					pos++;
+				} else {
+					if (dbcsCodePage) {
+						if (!NextCharacter(pos, increment)) {
+							break;
 						}
-					}
-					if (forward && UTF8IsAscii(leadByte)) {
-						pos++;
 					} else {
-						if (dbcsCodePage) {
-							if (!NextCharacter(pos, increment)) {
-								break;
-							}
-						} else {
-							pos += increment;
-						}
+						pos += increment;
 					}
 				}
 			}
-		} else if (CpUtf8 == dbcsCodePage) {
-			constexpr size_t maxFoldingExpansion = 4;
-			std::vector<char> searchThing((lengthFind+1) * UTF8MaxBytes * maxFoldingExpansion + 1);
-			const size_t lenSearch =
-				pcf->Fold(&searchThing[0], searchThing.size(), search, lengthFind);
-			while (forward ? (pos < endPos) : (pos >= endPos)) {
-				int widthFirstCharacter = 1;
-				Sci::Position posIndexDocument = pos;
-				size_t indexSearch = 0;
-				bool characterMatches = true;
-				while (indexSearch < lenSearch) {
-					const unsigned char leadByte = cbView.CharAt(posIndexDocument);
-					int widthChar = 1;
-					size_t lenFlat = 1;
-					if (UTF8IsAscii(leadByte)) {
-						if ((posIndexDocument + 1) > limitPos) {
-							break;
-						}
-						characterMatches = searchThing[indexSearch] == MakeLowerCase(leadByte);
-					} else {
-						char bytes[UTF8MaxBytes]{ static_cast<char>(leadByte) };
-						const int widthCharBytes = UTF8BytesOfLead[leadByte];
-						for (int b = 1; b < widthCharBytes; b++) {
-							bytes[b] = cbView.CharAt(posIndexDocument + b);
-						}
-						widthChar = UTF8Classify(bytes, widthCharBytes) & UTF8MaskWidth;
-						if (!indexSearch) {	// First character
-							widthFirstCharacter = widthChar;
-						}
-						if ((posIndexDocument + widthChar) > limitPos) {
+		}
+	} else if (CpUtf8 == dbcsCodePage) {
+		constexpr size_t maxFoldingExpansion = 4;
+		std::vector<char> searchThing((lengthFind+1) * UTF8MaxBytes * maxFoldingExpansion + 1);
+		const size_t lenSearch =
+			pcf->Fold(&searchThing[0], searchThing.size(), search, lengthFind);
+		// Skip ahead to possible first characters when searching forward for text starting with ASCII
+		const bool skipToCandidate = forward && UTF8IsAscii(search[0]);
+		const char chLower = MakeLowerCase(search[0]);
+		const char chUpper = MakeUpperCase(search[0]);
+		const bool asciiSearch = std::all_of(search, search + lengthFind, [](char ch) noexcept { return UTF8IsAscii(ch); });
+		while (forward ? (pos < endPos) : (pos >= endPos)) {
+			if (skipToCandidate) {
+				pos = SplitFindFoldCandidate(cbView, pos, endPos, chLower, chUpper);
+				if (pos < 0) {
+					break;
+				}
+				if (asciiSearch && (pos + lengthFind) <= limitPos) {
+					// ASCII text against ASCII search: compare lower cased bytes, only non-ASCII text needs folding
+					Sci::Position indexSearch = 0;
+					unsigned char ch = 0;
+					while (indexSearch < lengthFind) {
+						ch = cbView.CharAt(pos + indexSearch);
+						if (!UTF8IsAscii(ch) || MakeLowerCase(ch) != searchThing[indexSearch]) {
 							break;
 						}
-						char folded[UTF8MaxBytes * maxFoldingExpansion + 1];
-						lenFlat = pcf->Fold(folded, sizeof(folded), bytes, widthChar);
-						// memcmp may examine lenFlat bytes in both arguments so assert it doesn't read past end of searchThing
-						assert((indexSearch + lenFlat) <= searchThing.size());
-						// Does folded match the buffer
-						characterMatches = 0 == memcmp(folded, &searchThing[0] + indexSearch, lenFlat);
+						indexSearch++;
 					}
-					if (!characterMatches) {
-						break;
+					if (indexSearch == lengthFind) {
+						if (MatchesWordOptions(word, wordStart, pos, lengthFind)) {
+							return pos;
+						}
+						pos++;
+						continue;
+					} else if (UTF8IsAscii(ch)) {
+						pos++;
+						continue;
 					}
-					posIndexDocument += widthChar;
-					indexSearch += lenFlat;
 				}
-				if (characterMatches && (indexSearch == lenSearch)) {
-					if (MatchesWordOptions(word, wordStart, pos, posIndexDocument - pos)) {
-						*length = posIndexDocument - pos;
-						return pos;
+			}
+			int widthFirstCharacter = 1;
+			Sci::Position posIndexDocument = pos;
+			size_t indexSearch = 0;
+			bool characterMatches = true;
+			while (indexSearch < lenSearch) {
+				const unsigned char leadByte = cbView.CharAt(posIndexDocument);
+				int widthChar = 1;
+				size_t lenFlat = 1;
+				if (UTF8IsAscii(leadByte)) {
+					if ((posIndexDocument + 1) > limitPos) {
+						break;
 					}
-				}
-				if (forward) {
-					pos += widthFirstCharacter;
+					characterMatches = searchThing[indexSearch] == MakeLowerCase(leadByte);
 				} else {
-					if (!NextCharacter(pos, increment)) {
-						break;
+					char bytes[UTF8MaxBytes]{ static_cast<char>(leadByte) };
+					const int widthCharBytes = UTF8BytesOfLead[leadByte];
+					for (int b = 1; b < widthCharBytes; b++) {
+						bytes[b] = cbView.CharAt(posIndexDocument + b);
 					}
-				}
-			}
-		} else if (dbcsCodePage) {
-			constexpr size_t maxBytesCharacter = 2;
-			constexpr size_t maxFoldingExpansion = 4;
-			std::vector<char> searchThing((lengthFind+1) * maxBytesCharacter * maxFoldingExpansion + 1);
-			const size_t lenSearch = pcf->Fold(&searchThing[0], searchThing.size(), search, lengthFind);
-			while (forward ? (pos < endPos) : (pos >= endPos)) {
-				int widthFirstCharacter = 0;
-				Sci::Position indexDocument = 0;
-				size_t indexSearch = 0;
-				bool characterMatches = true;
-				while (((pos + indexDocument) < limitPos) &&
-					(indexSearch < lenSearch)) {
-					const unsigned char leadByte = cbView.CharAt(pos + indexDocument);
-					const int widthChar = (!UTF8IsAscii(leadByte) && IsDBCSLeadByteNoExcept(leadByte)) ? 2 : 1;
-					if (!widthFirstCharacter) {
+					widthChar = UTF8Classify(bytes, widthCharBytes) & UTF8MaskWidth;
+					if (!indexSearch) {	// First character
 						widthFirstCharacter = widthChar;
 					}
-					if ((pos + indexDocument + widthChar) > limitPos) {
+					if ((posIndexDocument + widthChar) > limitPos) {
 						break;
 					}
-					size_t lenFlat = 1;
-					if (widthChar == 1) {
-						characterMatches = searchThing[indexSearch] == MakeLowerCase(leadByte);
-					} else {
-						const char bytes[maxBytesCharacter + 1] {
-							static_cast<char>(leadByte),
-							cbView.CharAt(pos + indexDocument + 1)
-						};
-						char folded[maxBytesCharacter * maxFoldingExpansion + 1];
-						lenFlat = pcf->Fold(folded, sizeof(folded), bytes, widthChar);
-						// memcmp may examine lenFlat bytes in both arguments so assert it doesn't read past end of searchThing
-						assert((indexSearch + lenFlat) <= searchThing.size());
-						// Does folded match the buffer
-						characterMatches = 0 == memcmp(folded, &searchThing[0] + indexSearch, lenFlat);
-					}
-					if (!characterMatches) {
-						break;
-					}
-					indexDocument += widthChar;
-					indexSearch += lenFlat;
+					char folded[UTF8MaxBytes * maxFoldingExpansion + 1];
+					lenFlat = pcf->Fold(folded, sizeof(folded), bytes, widthChar);
+					// memcmp may examine lenFlat bytes in both arguments so assert it doesn't read past end of searchThing
+					assert((indexSearch + lenFlat) <= searchThing.size());
+					// Does folded match the buffer
+					characterMatches = 0 == memcmp(folded, &searchThing[0] + indexSearch, lenFlat);
 				}
-				if (characterMatches && (indexSearch == lenSearch)) {
-					if (MatchesWordOptions(word, wordStart, pos, indexDocument)) {
-						*length = indexDocument;
-						return pos;
-					}
+				if (!characterMatches) {
+					break;
 				}
-				if (forward) {
-					pos += widthFirstCharacter;
-				} else {
-					if (!NextCharacter(pos, increment)) {
-						break;
-					}
+				posIndexDocument += widthChar;
+				indexSearch += lenFlat;
+			}
+			if (characterMatches && (indexSearch == lenSearch)) {
+				if (MatchesWordOptions(word, wordStart, pos, posIndexDocument - pos)) {
+					*length = posIndexDocument - pos;
+					return pos;
 				}
 			}
-		} else {
-			const Sci::Position endSearch = (startPos <= endPos) ? endPos - lengthFind + 1 : endPos;
-			std::vector<char> searchThing(lengthFind + 1);
-			pcf->Fold(&searchThing[0], searchThing.size(), search, lengthFind);
-			while (forward ? (pos < endSearch) : (pos >= endSearch)) {
-				bool found = (pos + lengthFind) <= limitPos;
-				for (int indexSearch = 0; (indexSearch < lengthFind) && found; indexSearch++) {
-					const char ch = cbView.CharAt(pos + indexSearch);
-					const char chTest = searchThing[indexSearch];
-					if (UTF8IsAscii(ch)) {
-						found = chTest == MakeLowerCase(ch);
-					} else {
-						char folded[2];
-						pcf->Fold(folded, sizeof(folded), &ch, 1);
-						found = folded[0] == chTest;
-					}
+			if (forward) {
+				pos += widthFirstCharacter;
+			} else {
+				if (!NextCharacter(pos, increment)) {
+					break;
+				}
+			}
+		}
+	} else if (dbcsCodePage) {
+		constexpr size_t maxBytesCharacter = 2;
+		constexpr size_t maxFoldingExpansion = 4;
+		std::vector<char> searchThing((lengthFind+1) * maxBytesCharacter * maxFoldingExpansion + 1);
+		const size_t lenSearch = pcf->Fold(&searchThing[0], searchThing.size(), search, lengthFind);
+		while (forward ? (pos < endPos) : (pos >= endPos)) {
+			int widthFirstCharacter = 0;
+			Sci::Position indexDocument = 0;
+			size_t indexSearch = 0;
+			bool characterMatches = true;
+			while (((pos + indexDocument) < limitPos) &&
+				(indexSearch < lenSearch)) {
+				const unsigned char leadByte = cbView.CharAt(pos + indexDocument);
+				const int widthChar = (!UTF8IsAscii(leadByte) && IsDBCSLeadByteNoExcept(leadByte)) ? 2 : 1;
+				if (!widthFirstCharacter) {
+					widthFirstCharacter = widthChar;
+				}
+				if ((pos + indexDocument + widthChar) > limitPos) {
+					break;
 				}
-				if (found && MatchesWordOptions(word, wordStart, pos, lengthFind)) {
+				size_t lenFlat = 1;
+				if (widthChar == 1) {
+					characterMatches = searchThing[indexSearch] == MakeLowerCase(leadByte);
+				} else {
+					const char bytes[maxBytesCharacter + 1] {
+						static_cast<char>(leadByte),
+						cbView.CharAt(pos + indexDocument + 1)
+					};
+					char folded[maxBytesCharacter * maxFoldingExpansion + 1];
+					lenFlat = pcf->Fold(folded, sizeof(folded), bytes, widthChar);
+					// memcmp may examine lenFlat bytes in both arguments so assert it doesn't read past end of searchThing
+					assert((indexSearch + lenFlat) <= searchThing.size());
+					// Does folded match the buffer
+					characterMatches = 0 == memcmp(folded, &searchThing[0] + indexSearch, lenFlat);
+				}
+				if (!characterMatches) {
+					break;
+				}
+				indexDocument += widthChar;
+				indexSearch += lenFlat;
+			}
+			if (characterMatches && (indexSearch == lenSearch)) {
+				if (MatchesWordOptions(word, wordStart, pos, indexDocument)) {
+					*length = indexDocument;
 					return pos;
 				}
-				pos += increment;
+			}
+			if (forward) {
+				pos += widthFirstCharacter;
+			} else {
+				if (!NextCharacter(pos, increment)) {
+					break;
+				}
 			}
 		}
+	} else {
+		const Sci::Position endSearch = (startPos <= endPos) ? endPos - lengthFind + 1 : endPos;
+		std::vector<char> searchThing(lengthFind + 1);
+		pcf->Fold(&searchThing[0], searchThing.size(), search, lengthFind);
+		const bool skipToCandidate = forward && UTF8IsAscii(search[0]);
+		const char chLower = MakeLowerCase(search[0]);
+		const char chUpper = MakeUpperCase(search[0]);
+		while (forward ? (pos < endSearch) : (pos >= endSearch)) {
+			if (skipToCandidate) {
+				pos = SplitFindFoldCandidate(cbView, pos, endSearch, chLower, chUpper);
+				if (pos < 0) {
+					break;
+				}
+			}
+			bool found = (pos + lengthFind) <= limitPos;
+			for (int indexSearch = 0; (indexSearch < lengthFind) && found; indexSearch++) {
+				const char ch = cbView.CharAt(pos + indexSearch);
+				const char chTest = searchThing[indexSearch];
+				if (UTF8IsAscii(ch)) {
+					found = chTest == MakeLowerCase(ch);
+				} else {
+					char folded[2];
+					pcf->Fold(folded, sizeof(folded), &ch, 1);
+					found = folded[0] == chTest;
+				}
+			}
+			if (found && MatchesWordOptions(word, wordStart, pos, lengthFind)) {
+				return pos;
+			}
+			pos += increment;
+		}
 	}
 	//Platform::DebugPrintf("Not found\n");
 	return -1;
@@ -2649,6 +2948,67 @@ void SCI_METHOD Document::DecorationFillRange(Sci_Position position, int value,
 	}
 }
 
+void Document::DecorationReplaceRanges(int indicator, int value, const Sci::Position *ranges, size_t count) {
+	// Clear indicator then fill each (start, end) pair with a single notification for the whole change
+	const int indicatorPrevious = decorations->GetCurrentIndicator();
+	decorations->SetCurrentIndicator(indicator);
+	Sci::Position changeStart = Length();
+	Sci::Position changeEnd = 0;
+	const auto extend = [&](const FillResult<Sci::Position> &fr) noexcept {
+		if (fr.changed) {
+			changeStart = std::min(changeStart, fr.position);
+			changeEnd = std::max(changeEnd, fr.position + fr.fillLength);
+		}
+	};
+	extend(decorations->FillRange(0, 0, Length()));
+	for (size_t i = 0; i < count; i++) {
+		const Sci::Position start = ranges[i * 2];
+		const Sci::Position end = ranges[i * 2 + 1];
+		if (start < end)
+			extend(decorations->FillRange(start, value, end - start));
+	}
+	decorations->SetCurrentIndicator(indicatorPrevious);
+	if (changeStart < changeEnd) {
+		const DocModification mh(ModificationFlags::ChangeIndicator | ModificationFlags::User,
+							changeStart, changeEnd - changeStart);
+		NotifyModified(mh);
+	}
+}
+
+void Document::DecorationFillTerms(const AhoCorasick &matcher, const int *indicators, Sci::Position start, Sci::Position end) {
+	// Clear the indicators of every term over [start, end) then fill each match with its term number + 1
+	start = std::clamp<Sci::Position>(start, 0, Length());
+	end = std::clamp(end, start, Length());
+	const auto invalid = [](int indicator) noexcept {
+		return indicator < 0 || indicator > static_cast<int>(IndicatorNumbers::Max);
+	};
+	std::vector<int> used(indicators, indicators + matcher.Terms());
+	used.erase(std::remove_if(used.begin(), used.end(), invalid), used.end());
+	std::sort(used.begin(), used.end());
+	used.erase(std::unique(used.begin(), used.end()), used.end());
+	std::vector<AhoCorasick::Match> matches;
+	matcher.Scan(cb.AllView(), start, end, matches);
+
+	const int indicatorPrevious = decorations->GetCurrentIndicator();
+	bool changed = false;
+	for (const int indicator : used) {
+		decorations->SetCurrentIndicator(indicator);
+		changed = decorations->FillRange(start, 0, end - start).changed || changed;
+	}
+	for (const AhoCorasick::Match &match : matches) {
+		if (invalid(indicators[match.term])) {
+			continue;
+		}
+		decorations->SetCurrentIndicator(indicators[match.term]);
+		changed = decorations->FillRange(match.start, static_cast<int>(match.term + 1), match.end - match.start).changed || changed;
+	}
+	decorations->SetCurrentIndicator(indicatorPrevious);
+	if (changed) {
+		const DocModification mh(ModificationFlags::ChangeIndicator | ModificationFlags::User, start, end - start);
+		NotifyModified(mh);
+	}
+}
+
 bool Document::AddWatcher(DocWatcher *watcher, void *userData) {
 	const WatcherWithUserData wwud(watcher, userData);
 	std::vector<WatcherWithUserData>::iterator it =
@@ -2690,8 +3050,18 @@ void Document::NotifySavePoint(bool atSavePoint) {
 void Document::NotifyModified(DocModification mh) {
 	if (FlagSet(mh.modificationType, ModificationFlags::InsertText)) {
 		decorations->InsertSpace(mh.position, mh.length);
+		if (trigramIndex) {
+			trigramIndex->InsertText(cb.AllView(), mh.position, mh.length);
+		} else if (trigramEdits) {
+			trigramEdits->push_back(TrigramEdit { mh.position, mh.length });
+		}
 	} else if (FlagSet(mh.modificationType, ModificationFlags::DeleteText)) {
 		decorations->DeleteRange(mh.position, mh.length);
+		if (trigramIndex) {
+			trigramIndex->DeleteText(cb.AllView(), mh.position, mh.length);
+		} else if (trigramEdits) {
+			trigramEdits->push_back(TrigramEdit { mh.position, -mh.length });
+		}
 	}
 	for (const WatcherWithUserData &watcher : watchers) {
 		watcher.watcher->NotifyModified(this, mh, watcher.userData);
@@ -2864,7 +3234,7 @@ Sci::Position Document::BraceMatch(Sci::Position position, Sci::Position /*maxRe
  */
 class BuiltinRegex : public RegexSearchBase {
 public:
-	explicit BuiltinRegex(CharClassify *charClassTable) : search(charClassTable) {}
+	explicit BuiltinRegex(CharClassify *charClassTable) : search(charClassTable), charClass(charClassTable) {}
 
 	Sci::Position FindText(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
                         bool caseSensitive, bool word, bool wordStart, FindOption flags,
@@ -2875,6 +3245,8 @@ public:
 private:
 	RESearch search;
 	std::string substituted;
+	const CharClassify *charClass;
+	std::unique_ptr<LinearRegex> linear;
 };
 
 namespace {
@@ -3268,12 +3640,59 @@ Sci::Position Cxx11RegexFindText(const Document *doc, Sci::Position minPos, Sci:
 
 #endif
 
+Sci::Position LinearRegexFindText(const Document *doc, Sci::Position minPos, Sci::Position maxPos,
+	LinearRegex &regex, Sci::Position *length, RESearch &search) {
+	const RESearchRange resr(doc, minPos, maxPos);
+	const SplitView text = doc->AllView();
+	LinearRegex::Captures captures {};
+	bool matched = false;
+	if (resr.increment == 1) {
+		matched = regex.Find(text, resr.startPos, resr.endPos, captures);
+	} else {
+		// Backwards: the last of the forward matches in the range
+		LinearRegex::Captures candidate {};
+		Sci::Position pos = resr.endPos;
+		while (pos <= resr.startPos && regex.Find(text, pos, resr.startPos, candidate)) {
+			matched = true;
+			captures = candidate;
+			pos = (candidate[1] > candidate[0]) ? candidate[1] : doc->NextPosition(candidate[0], 1);
+			if (candidate[0] >= resr.startPos) {
+				break;
+			}
+		}
+	}
+	if (!matched) {
+		return -1;
+	}
+	search.Clear();
+	for (int co = 0; co < RESearch::MAXTAG; co++) {
+		search.bopat[co] = captures[co * 2];
+		search.eopat[co] = captures[co * 2 + 1];
+	}
+	*length = captures[1] - captures[0];
+	return captures[0];
+}
+
 }
 
 Sci::Position BuiltinRegex::FindText(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
                         bool caseSensitive, bool, bool, FindOption flags,
                         Sci::Position *length) {
 
+	if (FlagSet(flags, FindOption::LinearRegEx)) {
+		const std::string_view pattern(s, *length);
+		try {
+			if (!linear || !linear->SameAs(pattern, caseSensitive, doc->dbcsCodePage)) {
+				linear.reset();
+				linear = std::make_unique<LinearRegex>(pattern, caseSensitive, doc->dbcsCodePage, charClass);
+			}
+		} catch (std::runtime_error &) {
+			// Failed to compile regular expression
+			throw RegexError();
+		}
+		return LinearRegexFindText(doc, minPos, maxPos, *linear, length, search);
+	}
+
 #ifndef NO_CXX11_REGEX
 	if (FlagSet(flags, FindOption::Cxx11RegEx)) {
 			return Cxx11RegexFindText(doc, minPos, maxPos, s,
@@ -17,6 +17,9 @@ class LineMarkers;
 class LineLevels;
 class LineState;
 class LineAnnotation;
+class AhoCorasick;
+class TrigramIndex;
+struct TrigramEdit;
 
 enum class EncodingFamily { eightBit, unicode, dbcs };
 
@@ -304,6 +307,11 @@ private:
 	bool matchesValid;
 	std::unique_ptr<RegexSearchBase> regex;
 	std::unique_ptr<LexInterface> pli;
+	std::unique_ptr<TrigramIndex> trigramIndex;
+	/// Edits made while an index is built, replayed on it when it is set
+	std::unique_ptr<std::vector<TrigramEdit>> trigramEdits;
+
+	Sci::Position FindLiteral(Sci::Position minPos, Sci::Position maxPos, const char *search, Scintilla::FindOption flags, Sci::Position *length);
 
 public:
 
@@ -429,8 +437,12 @@ public:
 	[[nodiscard]] Sci::Position EditionNextDelete(Sci::Position pos) const noexcept { return cb.EditionNextDelete(pos); }
 
 	const char *SCI_METHOD BufferPointer() override { return cb.BufferPointer(); }
-	const char *RangePointer(Sci::Position position, Sci::Position rangeLength) noexcept { return cb.RangePointer(position, rangeLength); }
+	const char *RangePointer(Sci::Position position, Sci::Position rangeLength) { return cb.RangePointer(position, rangeLength); }
 	Sci::Position GapPosition() const noexcept { return cb.GapPosition(); }
+	SplitView AllView() const noexcept { return cb.AllView(); }
+	std::shared_ptr<PinnedText> PinText() { return cb.PinText(); }
+	bool TextPinned() const noexcept { return cb.TextPinned(); }
+	bool TextUnchangedSince(const PinnedText &pinned) const noexcept { return cb.TextUnchangedSince(pinned); }
 
 	int SCI_METHOD GetLineIndentation(Sci_Position line) override;
 	Sci::Position SetLineIndentation(Sci::Line line, Sci::Position indent);
@@ -498,6 +510,8 @@ public:
 	Sci_Position SCI_METHOD Length() const override { return cb.Length(); }
 	Sci::Position LengthNoExcept() const noexcept { return cb.Length(); }
 	void Allocate(Sci::Position newSize) { cb.Allocate(newSize); }
+	void SetMappedText(std::shared_ptr<const char> text, Sci::Position length);
+	bool IsMapped() const noexcept { return cb.IsMapped(); }
 
 	CharacterExtracted ExtractCharacter(Sci::Position position) const noexcept;
 
@@ -508,6 +522,9 @@ public:
 	bool MatchesWordOptions(bool word, bool wordStart, Sci::Position pos, Sci::Position length) const;
 	bool HasCaseFolder() const noexcept;
 	void SetCaseFolder(std::unique_ptr<CaseFolder> pcf_) noexcept;
+	TrigramIndex *GetTrigramIndex() const noexcept;
+	void StartTrigramBuild();
+	void SetTrigramIndex(std::unique_ptr<TrigramIndex> trigramIndex_);
 	Sci::Position FindText(Sci::Position minPos, Sci::Position maxPos, const char *search, Scintilla::FindOption flags, Sci::Position *length);
 	const char *SubstituteByPosition(const char *text, Sci::Position *length);
 	Scintilla::LineCharacterIndexType LineCharacterIndex() const noexcept;
@@ -531,6 +548,8 @@ public:
 	void IncrementStyleClock() noexcept;
 	void SCI_METHOD DecorationSetCurrentIndicator(int indicator) override;
 	void SCI_METHOD DecorationFillRange(Sci_Position position, int value, Sci_Position fillLength) override;
+	void DecorationReplaceRanges(int indicator, int value, const Sci::Position *ranges, size_t count);
+	void DecorationFillTerms(const AhoCorasick &matcher, const int *indicators, Sci::Position start, Sci::Position end);
 	LexInterface *GetLexInterface() const noexcept;
 	void SetLexInterface(std::unique_ptr<LexInterface> pLexInterface) noexcept;
 
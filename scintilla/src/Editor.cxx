@@ -508,7 +508,7 @@ void Editor::RedrawSelMargin(Sci::Line line, bool allAfter) {
 		rcMarkers.Move(-ptOrigin.x, -ptOrigin.y);
 		wMargin.InvalidateRectangle(rcMarkers);
 	} else {
-		wMain.InvalidateRectangle(rcMarkers);
+		RedrawRect(rcMarkers);
 		if (rcMarkers == rcMarkersFull) {
 			redrawPendingMargin = true;
 		}
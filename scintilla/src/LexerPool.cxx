@@ -0,0 +1,159 @@
+// Scintilla source code edit control
+/** @file LexerPool.cxx
+ ** Keeps released lexers configured for a language so they can be used again.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <functional>
+
+#include "ILexer.h"
+
+#include "LexerPool.h"
+
+using namespace Scintilla;
+using namespace Scintilla::Internal;
+
+namespace {
+
+// Forwards everything to the pooled lexer except Release which hands it back
+class PooledLexer final : public ILexer5 {
+	LexerPool *pool;
+	std::string key;
+	ILexer5 *lexer;
+public:
+	PooledLexer(LexerPool *pool_, std::string_view key_, ILexer5 *lexer_) :
+		pool(pool_), key(key_), lexer(lexer_) {
+	}
+	int SCI_METHOD Version() const override {
+		return lexer->Version();
+	}
+	void SCI_METHOD Release() override {
+		pool->Return(key, lexer);
+		delete this;
+	}
+	const char *SCI_METHOD PropertyNames() override {
+		return lexer->PropertyNames();
+	}
+	int SCI_METHOD PropertyType(const char *name) override {
+		return lexer->PropertyType(name);
+	}
+	const char *SCI_METHOD DescribeProperty(const char *name) override {
+		return lexer->DescribeProperty(name);
+	}
+	Sci_Position SCI_METHOD PropertySet(const char *key_, const char *val) override {
+		return lexer->PropertySet(key_, val);
+	}
+	const char *SCI_METHOD DescribeWordListSets() override {
+		return lexer->DescribeWordListSets();
+	}
+	Sci_Position SCI_METHOD WordListSet(int n, const char *wl) override {
+		return lexer->WordListSet(n, wl);
+	}
+	void SCI_METHOD Lex(Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle, IDocument *pAccess) override {
+		lexer->Lex(startPos, lengthDoc, initStyle, pAccess);
+	}
+	void SCI_METHOD Fold(Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle, IDocument *pAccess) override {
+		lexer->Fold(startPos, lengthDoc, initStyle, pAccess);
+	}
+	void *SCI_METHOD PrivateCall(int operation, void *pointer) override {
+		return lexer->PrivateCall(operation, pointer);
+	}
+	int SCI_METHOD LineEndTypesSupported() override {
+		return lexer->LineEndTypesSupported();
+	}
+	int SCI_METHOD AllocateSubStyles(int styleBase, int numberStyles) override {
+		return lexer->AllocateSubStyles(styleBase, numberStyles);
+	}
+	int SCI_METHOD SubStylesStart(int styleBase) override {
+		return lexer->SubStylesStart(styleBase);
+	}
+	int SCI_METHOD SubStylesLength(int styleBase) override {
+		return lexer->SubStylesLength(styleBase);
+	}
+	int SCI_METHOD StyleFromSubStyle(int subStyle) override {
+		return lexer->StyleFromSubStyle(subStyle);
+	}
+	int SCI_METHOD PrimaryStyleFromStyle(int style) override {
+		return lexer->PrimaryStyleFromStyle(style);
+	}
+	void SCI_METHOD FreeSubStyles() override {
+		lexer->FreeSubStyles();
+	}
+	void SCI_METHOD SetIdentifiers(int style, const char *identifiers) override {
+		lexer->SetIdentifiers(style, identifiers);
+	}
+	int SCI_METHOD DistanceToSecondaryStyles() override {
+		return lexer->DistanceToSecondaryStyles();
+	}
+	const char *SCI_METHOD GetSubStyleBases() override {
+		return lexer->GetSubStyleBases();
+	}
+	int SCI_METHOD NamedStyles() override {
+		return lexer->NamedStyles();
+	}
+	const char *SCI_METHOD NameOfStyle(int style) override {
+		return lexer->NameOfStyle(style);
+	}
+	const char *SCI_METHOD TagsOfStyle(int style) override {
+		return lexer->TagsOfStyle(style);
+	}
+	const char *SCI_METHOD DescriptionOfStyle(int style) override {
+		return lexer->DescriptionOfStyle(style);
+	}
+	const char *SCI_METHOD GetName() override {
+		return lexer->GetName();
+	}
+	int SCI_METHOD GetIdentifier() override {
+		return lexer->GetIdentifier();
+	}
+	const char *SCI_METHOD PropertyGet(const char *key_) override {
+		return lexer->PropertyGet(key_);
+	}
+};
+
+}
+
+LexerPool::LexerPool(size_t capacity_) noexcept : capacity(capacity_) {
+}
+
+LexerPool::~LexerPool() {
+	for (const auto &[key, lexers] : idle) {
+		for (ILexer5 *lexer : lexers) {
+			lexer->Release();
+		}
+	}
+}
+
+ILexer5 *LexerPool::Take(std::string_view key) {
+	const auto it = idle.find(key);
+	if (it == idle.end() || it->second.empty()) {
+		return nullptr;
+	}
+	ILexer5 *lexer = it->second.back();
+	ILexer5 *pooled = new PooledLexer(this, key, lexer);
+	it->second.pop_back();
+	return pooled;
+}
+
+ILexer5 *LexerPool::Wrap(std::string_view key, ILexer5 *lexer) {
+	return new PooledLexer(this, key, lexer);
+}
+
+void LexerPool::Return(const std::string &key, ILexer5 *lexer) noexcept {
+	try {
+		std::vector<ILexer5 *> &lexers = idle[key];
+		if (lexers.size() < capacity) {
+			lexers.push_back(lexer);
+			return;
+		}
+	} catch (...) {
+		// Out of memory so drop the lexer
+	}
+	lexer->Release();
+}
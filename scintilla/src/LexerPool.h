@@ -0,0 +1,42 @@
+// Scintilla source code edit control
+/** @file LexerPool.h
+ ** Keeps released lexers configured for a language so they can be used again.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef LEXERPOOL_H
+#define LEXERPOOL_H
+
+namespace Scintilla::Internal {
+
+/**
+ * Lexers handed out are wrapped so that when a document releases its lexer the
+ * instance goes back to the pool under its key with its keyword lists and properties
+ * still set instead of being destroyed.
+ * The key names a complete configuration such as a language and not just a lexer.
+ * At most capacity idle lexers are kept per key, any more are destroyed.
+ */
+class LexerPool {
+public:
+	explicit LexerPool(size_t capacity_) noexcept;
+	// Deleted so LexerPool objects can not be copied.
+	LexerPool(const LexerPool &) = delete;
+	LexerPool(LexerPool &&) = delete;
+	LexerPool &operator=(const LexerPool &) = delete;
+	LexerPool &operator=(LexerPool &&) = delete;
+	~LexerPool();
+
+	/// A lexer last configured under key or nullptr when none is idle.
+	ILexer5 *Take(std::string_view key);
+	/// Wrap a newly created lexer so it returns to the pool under key when released.
+	ILexer5 *Wrap(std::string_view key, ILexer5 *lexer);
+	void Return(const std::string &key, ILexer5 *lexer) noexcept;
+
+private:
+	std::map<std::string, std::vector<ILexer5 *>, std::less<>> idle;
+	size_t capacity;
+};
+
+}
+
+#endif
@@ -8,7 +8,9 @@
 
 #include <cstring>
 
+#include <string_view>
 #include <vector>
+#include <unordered_map>
 #include <initializer_list>
 
 #if defined(_WIN32)
@@ -171,6 +173,15 @@ extern const LexerModule lmZig;
 namespace {
 
 CatalogueModules catalogueLexilla;
+// Catalogue index of each lexer name, the first module wins when names repeat
+std::unordered_map<std::string_view, size_t> lexerIndex;
+
+void IndexLexer(size_t index) {
+	const char *lexerName = catalogueLexilla.Name(index);
+	if (lexerName) {
+		lexerIndex.emplace(lexerName, index);
+	}
+}
 
 void AddEachLexer() {
 
@@ -322,6 +333,9 @@ void AddEachLexer() {
 //--Autogenerated -- end of automatically generated section
 		});
 
+	for (size_t i = 0; i < catalogueLexilla.Count(); i++) {
+		IndexLexer(i);
+	}
 }
 
 }
@@ -349,13 +363,14 @@ EXPORT_FUNCTION LexerFactoryFunction CALLING_CONVENTION GetLexerFactory(unsigned
 
 EXPORT_FUNCTION Scintilla::ILexer5 * CALLING_CONVENTION CreateLexer(const char *name) {
 	AddEachLexer();
-	for (size_t i = 0; i < catalogueLexilla.Count(); i++) {
-		const char *lexerName = catalogueLexilla.Name(i);
-		if (0 == strcmp(lexerName, name)) {
-			return catalogueLexilla.Create(i);
-		}
+	if (!name) {
+		return nullptr;
 	}
-	return nullptr;
+	const auto it = lexerIndex.find(name);
+	if (it == lexerIndex.end()) {
+		return nullptr;
+	}
+	return catalogueLexilla.Create(it->second);
 }
 
 EXPORT_FUNCTION const char * CALLING_CONVENTION LexerNameFromID(int identifier) {
@@ -386,4 +401,5 @@ EXPORT_FUNCTION const char * CALLING_CONVENTION GetNameSpace() {
 void AddStaticLexerModule(const LexerModule *plm) {
 	AddEachLexer();
 	catalogueLexilla.AddLexerModule(plm);
+	IndexLexer(catalogueLexilla.Count() - 1);
 }
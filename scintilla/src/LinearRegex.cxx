@@ -0,0 +1,890 @@
+// Scintilla source code edit control
+/** @file LinearRegex.cxx
+ ** Regular expression search in time linear to the length of the text.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <utility>
+#include <memory>
+
+#include "ScintillaTypes.h"
+
+#include "Debugging.h"
+
+#include "CharacterType.h"
+#include "CharacterCategoryMap.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "CharClassify.h"
+#include "CaseConvert.h"
+#include "UniConversion.h"
+#include "DBCS.h"
+#include "LinearRegex.h"
+
+using namespace Scintilla;
+using namespace Scintilla::Internal;
+
+namespace {
+
+// Regex errors are reported the same way as the other engines
+struct LinearRegexError : public std::runtime_error {
+	LinearRegexError() : std::runtime_error("regex failure") {}
+};
+
+// Limits so that counted repetition can not expand to an unreasonable program
+constexpr size_t maxInstructions = 20000;
+constexpr int maxRepeat = 1000;
+
+// Bytes that are not valid in the encoding are reported as characters above Unicode
+constexpr int invalidBase = 0x110000;
+constexpr int noCharacter = -1;
+
+struct Decoded {
+	int ch;
+	int width;
+};
+
+Decoded DecodeAt(const SplitView &text, Sci::Position position, int codePage) noexcept {
+	if (position < 0 || static_cast<size_t>(position) >= text.length) {
+		return { noCharacter, 0 };
+	}
+	const unsigned char lead = text.CharAt(position);
+	if (UTF8IsAscii(lead) || !codePage) {
+		return { lead, 1 };
+	}
+	if (codePage == CpUtf8) {
+		unsigned char bytes[UTF8MaxBytes] { lead };
+		const int widthLead = UTF8BytesOfLead[lead];
+		for (int b = 1; b < widthLead; b++) {
+			bytes[b] = text.CharAt(position + b);
+		}
+		const int utf8Status = UTF8Classify(bytes, widthLead);
+		if (utf8Status & UTF8MaskInvalid) {
+			return { invalidBase + lead, 1 };
+		}
+		return { UnicodeFromUTF8(bytes), utf8Status & UTF8MaskWidth };
+	}
+	if (DBCSIsLeadByte(codePage, lead) && (static_cast<size_t>(position) + 1 < text.length)) {
+		const unsigned char trail = text.CharAt(position + 1);
+		return { (lead << 8) | trail, 2 };
+	}
+	return { lead, 1 };
+}
+
+int DecodeBefore(const SplitView &text, Sci::Position position, int codePage) noexcept {
+	if (position <= 0) {
+		return noCharacter;
+	}
+	if (codePage == CpUtf8) {
+		Sci::Position back = position - 1;
+		while ((back > 0) && (back > position - UTF8MaxBytes) && UTF8IsTrailByte(text.CharAt(back))) {
+			back--;
+		}
+		const Decoded decoded = DecodeAt(text, back, codePage);
+		if (back + decoded.width == position) {
+			return decoded.ch;
+		}
+		return invalidBase + static_cast<unsigned char>(text.CharAt(position - 1));
+	}
+	// DBCS can not be decoded backwards reliably but only the class is used and
+	// both bytes of a DBCS character are word characters.
+	return static_cast<unsigned char>(text.CharAt(position - 1));
+}
+
+// Convert a character to a single character or return it unchanged
+int ConvertCase(int ch, CaseConversion conversion, int codePage) {
+	if (ch < 0x80) {
+		return (conversion == CaseConversion::upper) ? MakeUpperCase(ch) : MakeLowerCase(ch);
+	}
+	if (codePage != CpUtf8 || ch >= invalidBase) {
+		return ch;
+	}
+	const char *converted = CaseConvert(ch, conversion);
+	if (converted && *converted) {
+		const unsigned char *uconverted = reinterpret_cast<const unsigned char *>(converted);
+		if (converted[UTF8BytesOfLead[uconverted[0]]] == '\0') {
+			return UnicodeFromUTF8(uconverted);
+		}
+	}
+	return ch;
+}
+
+struct RegexNode {
+	enum class Kind { empty, character, any, set, assertion, group, concat, alternate, repeat };
+	Kind kind = Kind::empty;
+	int value = 0;	// character, set index, assertion op or group number (-1 when not capturing)
+	int min = 0;
+	int max = 0;	// -1 for unbounded
+	bool greedy = true;
+	std::vector<RegexNode> children;
+	explicit RegexNode(Kind kind_, int value_=0) : kind(kind_), value(value_) {}
+};
+
+class RegexParser {
+	std::string_view pattern;
+	size_t pos = 0;
+	bool caseSensitive;
+	int codePage;
+	std::vector<RegexCharacterSet> &sets;
+	int groups = 1;
+public:
+	RegexParser(std::string_view pattern_, bool caseSensitive_, int codePage_, std::vector<RegexCharacterSet> &sets_) noexcept :
+		pattern(pattern_), caseSensitive(caseSensitive_), codePage(codePage_), sets(sets_) {
+	}
+	RegexNode Parse() {
+		RegexNode node = ParseAlternation();
+		if (!AtEnd()) {
+			throw LinearRegexError();	// Unbalanced ')'
+		}
+		return node;
+	}
+	int Groups() const noexcept {
+		return std::min(groups, LinearRegex::maxGroups);
+	}
+private:
+	bool AtEnd() const noexcept {
+		return pos >= pattern.length();
+	}
+	char Peek() const noexcept {
+		return AtEnd() ? '\0' : pattern[pos];
+	}
+	int Literal(int ch) const {
+		return caseSensitive ? ch : ConvertCase(ch, CaseConversion::fold, codePage);
+	}
+	int NextCharacter() {
+		if (AtEnd()) {
+			throw LinearRegexError();
+		}
+		const unsigned char lead = pattern[pos];
+		if (UTF8IsAscii(lead) || !codePage) {
+			pos++;
+			return lead;
+		}
+		if (codePage == CpUtf8) {
+			const int widthLead = UTF8BytesOfLead[lead];
+			unsigned char bytes[UTF8MaxBytes] { lead };
+			for (int b = 1; b < widthLead && (pos + b) < pattern.length(); b++) {
+				bytes[b] = pattern[pos + b];
+			}
+			const int utf8Status = UTF8Classify(bytes, std::min<size_t>(widthLead, pattern.length() - pos));
+			if (utf8Status & UTF8MaskInvalid) {
+				pos++;
+				return invalidBase + lead;
+			}
+			pos += utf8Status & UTF8MaskWidth;
+			return UnicodeFromUTF8(bytes);
+		}
+		if (DBCSIsLeadByte(codePage, lead) && (pos + 1) < pattern.length()) {
+			const unsigned char trail = pattern[pos + 1];
+			pos += 2;
+			return (lead << 8) | trail;
+		}
+		pos++;
+		return lead;
+	}
+	int HexDigit() {
+		const char ch = Peek();
+		pos++;
+		if (IsADigit(ch)) {
+			return ch - '0';
+		}
+		if (ch >= 'a' && ch <= 'f') {
+			return ch - 'a' + 10;
+		}
+		if (ch >= 'A' && ch <= 'F') {
+			return ch - 'A' + 10;
+		}
+		throw LinearRegexError();
+	}
+	// Character value of an escape sequence after the '\'
+	int EscapedCharacter() {
+		switch (Peek()) {
+		case 'a': pos++; return '\a';
+		case 'e': pos++; return '\x1B';
+		case 'f': pos++; return '\f';
+		case 'n': pos++; return '\n';
+		case 'r': pos++; return '\r';
+		case 't': pos++; return '\t';
+		case 'v': pos++; return '\v';
+		case 'x': {
+				pos++;
+				const int high = HexDigit();
+				return high * 16 + HexDigit();
+			}
+		default:
+			if (IsADigit(Peek())) {
+				throw LinearRegexError();	// Back references are not regular
+			}
+			return NextCharacter();
+		}
+	}
+	static int ClassOfEscape(char ch) noexcept {
+		switch (ch) {
+		case 'd': return RegexCharacterSet::digit;
+		case 'D': return RegexCharacterSet::notDigit;
+		case 'w': return RegexCharacterSet::word;
+		case 'W': return RegexCharacterSet::notWord;
+		case 's': return RegexCharacterSet::space;
+		case 'S': return RegexCharacterSet::notSpace;
+		default: return 0;
+		}
+	}
+	int AddSet(RegexCharacterSet &&set) {
+		sets.push_back(std::move(set));
+		return static_cast<int>(sets.size() - 1);
+	}
+	void AddPosixClass(RegexCharacterSet &set, std::string_view name) {
+		if (name == "alpha") {
+			set.ranges.emplace_back('a', 'z');
+			set.ranges.emplace_back('A', 'Z');
+		} else if (name == "digit") {
+			set.classes |= RegexCharacterSet::digit;
+		} else if (name == "alnum") {
+			set.ranges.emplace_back('a', 'z');
+			set.ranges.emplace_back('A', 'Z');
+			set.classes |= RegexCharacterSet::digit;
+		} else if (name == "space") {
+			set.classes |= RegexCharacterSet::space;
+		} else if (name == "upper") {
+			set.ranges.emplace_back('A', 'Z');
+		} else if (name == "lower") {
+			set.ranges.emplace_back('a', 'z');
+		} else if (name == "xdigit") {
+			set.ranges.emplace_back('0', '9');
+			set.ranges.emplace_back('a', 'f');
+			set.ranges.emplace_back('A', 'F');
+		} else if (name == "punct") {
+			for (int ch = '!'; ch <= '~'; ch++) {
+				if (IsPunctuation(ch)) {
+					set.ranges.emplace_back(ch, ch);
+				}
+			}
+		} else if (name == "word") {
+			set.classes |= RegexCharacterSet::word;
+		} else {
+			throw LinearRegexError();
+		}
+	}
+	RegexNode ParseSet() {
+		pos++;	// '['
+		RegexCharacterSet set;
+		if (Peek() == '^') {
+			set.negated = true;
+			pos++;
+		}
+		bool first = true;
+		for (;;) {
+			if (AtEnd()) {
+				throw LinearRegexError();
+			}
+			if (Peek() == ']' && !first) {
+				pos++;
+				break;
+			}
+			first = false;
+			if (pattern.substr(pos, 2) == "[:") {
+				const size_t end = pattern.find(":]", pos + 2);
+				if (end == std::string_view::npos) {
+					throw LinearRegexError();
+				}
+				AddPosixClass(set, pattern.substr(pos + 2, end - pos - 2));
+				pos = end + 2;
+				continue;
+			}
+			int low = 0;
+			if (Peek() == '\\') {
+				pos++;
+				const int classOfEscape = ClassOfEscape(Peek());
+				if (classOfEscape) {
+					set.classes |= classOfEscape;
+					pos++;
+					continue;
+				}
+				low = EscapedCharacter();
+			} else {
+				low = NextCharacter();
+			}
+			int high = low;
+			if (Peek() == '-' && (pos + 1) < pattern.length() && pattern[pos + 1] != ']') {
+				pos++;
+				if (Peek() == '\\') {
+					pos++;
+					high = EscapedCharacter();
+				} else {
+					high = NextCharacter();
+				}
+				if (high < low) {
+					throw LinearRegexError();
+				}
+			}
+			set.ranges.emplace_back(low, high);
+		}
+		return RegexNode(RegexNode::Kind::set, AddSet(std::move(set)));
+	}
+	RegexNode ParseEscape() {
+		pos++;	// '\'
+		if (AtEnd()) {
+			throw LinearRegexError();
+		}
+		const char ch = Peek();
+		const int classOfEscape = ClassOfEscape(ch);
+		if (classOfEscape) {
+			pos++;
+			RegexCharacterSet set;
+			set.classes = classOfEscape;
+			return RegexNode(RegexNode::Kind::set, AddSet(std::move(set)));
+		}
+		switch (ch) {
+		case 'b':
+			pos++;
+			return RegexNode(RegexNode::Kind::assertion, static_cast<int>(RegexOp::wordBoundary));
+		case 'B':
+			pos++;
+			return RegexNode(RegexNode::Kind::assertion, static_cast<int>(RegexOp::notWordBoundary));
+		case '<':
+			pos++;
+			return RegexNode(RegexNode::Kind::assertion, static_cast<int>(RegexOp::wordStart));
+		case '>':
+			pos++;
+			return RegexNode(RegexNode::Kind::assertion, static_cast<int>(RegexOp::wordEnd));
+		default:
+			return RegexNode(RegexNode::Kind::character, Literal(EscapedCharacter()));
+		}
+	}
+	RegexNode ParseAtom() {
+		switch (Peek()) {
+		case '(': {
+				pos++;
+				int group = -1;
+				if (pattern.substr(pos, 2) == "?:") {
+					pos += 2;
+				} else {
+					// Groups past the last capture slot still group but are not captured
+					if (groups < LinearRegex::maxGroups) {
+						group = groups;
+					}
+					groups++;
+				}
+				RegexNode node(RegexNode::Kind::group, group);
+				node.children.push_back(ParseAlternation());
+				if (Peek() != ')') {
+					throw LinearRegexError();
+				}
+				pos++;
+				return node;
+			}
+		case '*':
+		case '+':
+		case '?':
+			throw LinearRegexError();	// Nothing to repeat
+		case '.':
+			pos++;
+			return RegexNode(RegexNode::Kind::any);
+		case '^':
+			pos++;
+			return RegexNode(RegexNode::Kind::assertion, static_cast<int>(RegexOp::lineStart));
+		case '$':
+			pos++;
+			return RegexNode(RegexNode::Kind::assertion, static_cast<int>(RegexOp::lineEnd));
+		case '[':
+			return ParseSet();
+		case '\\':
+			return ParseEscape();
+		default:
+			return RegexNode(RegexNode::Kind::character, Literal(NextCharacter()));
+		}
+	}
+	int Number() {
+		int value = 0;
+		const size_t start = pos;
+		while (IsADigit(Peek())) {
+			value = value * 10 + (Peek() - '0');
+			if (value > maxRepeat) {
+				throw LinearRegexError();
+			}
+			pos++;
+		}
+		return (pos == start) ? -1 : value;
+	}
+	// {n} {n,} {n,m} or restore position and return false to treat '{' as a literal
+	bool Count(int &min, int &max) {
+		const size_t start = pos;
+		pos++;	// '{'
+		min = Number();
+		max = min;
+		if (Peek() == ',') {
+			pos++;
+			max = Number();
+		}
+		if (min < 0 || Peek() != '}') {
+			pos = start;
+			return false;
+		}
+		pos++;
+		if (max >= 0 && max < min) {
+			throw LinearRegexError();
+		}
+		return true;
+	}
+	RegexNode ParseRepeat() {
+		RegexNode atom = ParseAtom();
+		for (;;) {
+			int min = 0;
+			int max = -1;
+			const char ch = Peek();
+			if (ch == '*') {
+				pos++;
+			} else if (ch == '+') {
+				min = 1;
+				pos++;
+			} else if (ch == '?') {
+				max = 1;
+				pos++;
+			} else if (ch != '{' || !Count(min, max)) {
+				return atom;
+			}
+			if (atom.kind == RegexNode::Kind::assertion) {
+				throw LinearRegexError();
+			}
+			RegexNode repeat(RegexNode::Kind::repeat);
+			repeat.min = min;
+			repeat.max = max;
+			if (Peek() == '?') {
+				repeat.greedy = false;
+				pos++;
+			}
+			repeat.children.push_back(std::move(atom));
+			atom = std::move(repeat);
+		}
+	}
+	RegexNode ParseConcatenation() {
+		RegexNode concat(RegexNode::Kind::concat);
+		while (!AtEnd() && Peek() != '|' && Peek() != ')') {
+			concat.children.push_back(ParseRepeat());
+		}
+		return concat;
+	}
+	RegexNode ParseAlternation() {
+		RegexNode first = ParseConcatenation();
+		if (Peek() != '|') {
+			return first;
+		}
+		RegexNode alternate(RegexNode::Kind::alternate);
+		alternate.children.push_back(std::move(first));
+		while (Peek() == '|') {
+			pos++;
+			alternate.children.push_back(ParseConcatenation());
+		}
+		return alternate;
+	}
+};
+
+class RegexCompiler {
+	std::vector<RegexInstruction> &program;
+public:
+	explicit RegexCompiler(std::vector<RegexInstruction> &program_) noexcept : program(program_) {
+	}
+	int Here() const noexcept {
+		return static_cast<int>(program.size());
+	}
+	int Emit(RegexOp op, int arg=0, int arg2=0) {
+		if (program.size() >= maxInstructions) {
+			throw LinearRegexError();
+		}
+		program.push_back({ op, arg, arg2 });
+		return Here() - 1;
+	}
+	void SetBranches(int split, int body, int skip, bool greedy) noexcept {
+		program[split].arg = greedy ? body : skip;
+		program[split].arg2 = greedy ? skip : body;
+	}
+	void Compile(const RegexNode &node) {
+		switch (node.kind) {
+		case RegexNode::Kind::empty:
+			break;
+		case RegexNode::Kind::character:
+			Emit(RegexOp::character, node.value);
+			break;
+		case RegexNode::Kind::any:
+			Emit(RegexOp::any);
+			break;
+		case RegexNode::Kind::set:
+			Emit(RegexOp::set, node.value);
+			break;
+		case RegexNode::Kind::assertion:
+			Emit(static_cast<RegexOp>(node.value));
+			break;
+		case RegexNode::Kind::group:
+			if (node.value >= 0) {
+				Emit(RegexOp::save, node.value * 2);
+			}
+			Compile(node.children.front());
+			if (node.value >= 0) {
+				Emit(RegexOp::save, node.value * 2 + 1);
+			}
+			break;
+		case RegexNode::Kind::concat:
+			for (const RegexNode &child : node.children) {
+				Compile(child);
+			}
+			break;
+		case RegexNode::Kind::alternate: {
+				std::vector<int> jumps;
+				for (size_t i = 0; i + 1 < node.children.size(); i++) {
+					const int split = Emit(RegexOp::split);
+					Compile(node.children[i]);
+					jumps.push_back(Emit(RegexOp::jump));
+					SetBranches(split, split + 1, Here(), true);
+				}
+				Compile(node.children.back());
+				for (const int jump : jumps) {
+					program[jump].arg = Here();
+				}
+			}
+			break;
+		case RegexNode::Kind::repeat: {
+				const RegexNode &child = node.children.front();
+				for (int i = 0; i < node.min; i++) {
+					Compile(child);
+				}
+				if (node.max < 0) {
+					const int split = Emit(RegexOp::split);
+					Compile(child);
+					Emit(RegexOp::jump, split);
+					SetBranches(split, split + 1, Here(), node.greedy);
+				} else {
+					std::vector<int> splits;
+					for (int i = node.min; i < node.max; i++) {
+						splits.push_back(Emit(RegexOp::split));
+						Compile(child);
+					}
+					for (const int split : splits) {
+						SetBranches(split, split + 1, Here(), node.greedy);
+					}
+				}
+			}
+			break;
+		}
+	}
+};
+
+// Literal text that every match starts with
+std::string RequiredPrefix(const RegexNode &root, int codePage) {
+	std::string prefix;
+	const auto append = [&prefix, codePage](int ch) {
+		if (ch >= invalidBase) {
+			prefix.push_back(static_cast<char>(ch - invalidBase));
+		} else if (codePage == CpUtf8) {
+			char bytes[UTF8MaxBytes + 1] {};
+			UTF8FromUTF32Character(ch, bytes);
+			prefix.append(bytes);
+		} else if (ch > 0xFF) {
+			prefix.push_back(static_cast<char>(ch >> 8));
+			prefix.push_back(static_cast<char>(ch & 0xFF));
+		} else {
+			prefix.push_back(static_cast<char>(ch));
+		}
+	};
+	if (root.kind == RegexNode::Kind::character) {
+		append(root.value);
+	} else if (root.kind == RegexNode::Kind::concat) {
+		for (const RegexNode &child : root.children) {
+			if (child.kind != RegexNode::Kind::character) {
+				break;
+			}
+			append(child.value);
+		}
+	}
+	return prefix;
+}
+
+}
+
+LinearRegex::LinearRegex(std::string_view pattern_, bool caseSensitive_, int codePage_, const CharClassify *charClass_) :
+	pattern(pattern_), caseSensitive(caseSensitive_), codePage(codePage_), charClass(charClass_) {
+	RegexParser parser(pattern, caseSensitive, codePage, sets);
+	const RegexNode root = parser.Parse();
+	slots = parser.Groups() * 2;
+
+	RegexCompiler compiler(program);
+	compiler.Emit(RegexOp::save, 0);
+	compiler.Compile(root);
+	compiler.Emit(RegexOp::save, 1);
+	compiler.Emit(RegexOp::match);
+
+	// Prefix search has to land on character starts which DBCS trail bytes prevent
+	if (caseSensitive && !IsDBCSCodePage(codePage)) {
+		prefix = RequiredPrefix(root, codePage);
+	}
+
+	for (ThreadList &list : threads) {
+		list.sparse.resize(program.size());
+		list.dense.resize(program.size());
+		list.captures.resize(program.size() * slots);
+	}
+	work.resize(slots);
+}
+
+bool LinearRegex::SameAs(std::string_view pattern_, bool caseSensitive_, int codePage_) const noexcept {
+	return pattern == pattern_ && caseSensitive == caseSensitive_ && codePage == codePage_;
+}
+
+int LinearRegex::Fold(int ch) const {
+	return caseSensitive ? ch : ConvertCase(ch, CaseConversion::fold, codePage);
+}
+
+bool LinearRegex::IsWord(int ch) const noexcept {
+	if (ch < 0 || ch >= invalidBase) {
+		return false;
+	}
+	if (ch < 0x80 || (!codePage && ch < 0x100)) {
+		return charClass->GetClass(static_cast<unsigned char>(ch)) == CharacterClass::word;
+	}
+	if (codePage != CpUtf8) {
+		return true;
+	}
+	switch (CategoriseCharacter(ch)) {
+	case ccLu:
+	case ccLl:
+	case ccLt:
+	case ccLm:
+	case ccLo:
+	case ccNd:
+	case ccNl:
+	case ccNo:
+	case ccMn:
+	case ccMc:
+	case ccMe:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool LinearRegex::SetContains(const RegexCharacterSet &set, int ch) const {
+	for (const std::pair<int, int> &range : set.ranges) {
+		if (ch >= range.first && ch <= range.second) {
+			return true;
+		}
+	}
+	if (set.classes) {
+		const bool digit = IsADigit(ch);
+		const bool space = IsSpaceOrTab(ch) || (ch >= '\n' && ch <= '\r') ||
+			(codePage == CpUtf8 && ch >= 0x80 && ch < invalidBase && CategoriseCharacter(ch) == ccZs);
+		const bool word = IsWord(ch);
+		if (((set.classes & RegexCharacterSet::digit) && digit) ||
+			((set.classes & RegexCharacterSet::notDigit) && !digit) ||
+			((set.classes & RegexCharacterSet::word) && word) ||
+			((set.classes & RegexCharacterSet::notWord) && !word) ||
+			((set.classes & RegexCharacterSet::space) && space) ||
+			((set.classes & RegexCharacterSet::notSpace) && !space)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool LinearRegex::SetContainsCase(const RegexCharacterSet &set, int ch) const {
+	bool contains = SetContains(set, ch);
+	if (!contains && !caseSensitive) {
+		contains = SetContains(set, ConvertCase(ch, CaseConversion::lower, codePage)) ||
+			SetContains(set, ConvertCase(ch, CaseConversion::upper, codePage));
+	}
+	return contains != set.negated;
+}
+
+bool LinearRegex::Assertion(RegexOp op, int chPrevious, int ch) const noexcept {
+	switch (op) {
+	case RegexOp::lineStart:
+		return chPrevious == noCharacter || chPrevious == '\n' || (chPrevious == '\r' && ch != '\n');
+	case RegexOp::lineEnd:
+		return ch == noCharacter || ch == '\r' || (ch == '\n' && chPrevious != '\r');
+	case RegexOp::wordBoundary:
+		return IsWord(chPrevious) != IsWord(ch);
+	case RegexOp::notWordBoundary:
+		return IsWord(chPrevious) == IsWord(ch);
+	case RegexOp::wordStart:
+		return !IsWord(chPrevious) && IsWord(ch);
+	case RegexOp::wordEnd:
+		return IsWord(chPrevious) && !IsWord(ch);
+	default:
+		return false;
+	}
+}
+
+// Follow the non-consuming instructions from pc, adding each reached state once with its captures
+void LinearRegex::AddThread(ThreadList &list, int pc, Sci::Position position, int chPrevious, int ch, const Sci::Position *from) {
+	const RegexOp opFirst = program[pc].op;
+	if (opFirst == RegexOp::character || opFirst == RegexOp::any || opFirst == RegexOp::set || opFirst == RegexOp::match) {
+		// Most steps land directly on a consuming instruction so avoid the stack
+		if (!list.Contains(pc)) {
+			const size_t index = list.Add(pc);
+			std::copy(from, from + slots, list.captures.begin() + index * slots);
+		}
+		return;
+	}
+	std::copy(from, from + slots, work.begin());
+	stack.push_back({ pc, -1, 0 });
+	while (!stack.empty()) {
+		const Frame frame = stack.back();
+		stack.pop_back();
+		if (frame.slot >= 0) {
+			work[frame.slot] = frame.value;
+			continue;
+		}
+		if (list.Contains(frame.pc)) {
+			continue;
+		}
+		const size_t index = list.Add(frame.pc);
+
+		const RegexInstruction &instruction = program[frame.pc];
+		switch (instruction.op) {
+		case RegexOp::jump:
+			stack.push_back({ instruction.arg, -1, 0 });
+			break;
+		case RegexOp::split:
+			stack.push_back({ instruction.arg2, -1, 0 });
+			stack.push_back({ instruction.arg, -1, 0 });
+			break;
+		case RegexOp::save:
+			if (instruction.arg < slots) {
+				stack.push_back({ 0, instruction.arg, work[instruction.arg] });
+				work[instruction.arg] = position;
+			}
+			stack.push_back({ frame.pc + 1, -1, 0 });
+			break;
+		case RegexOp::lineStart:
+		case RegexOp::lineEnd:
+		case RegexOp::wordBoundary:
+		case RegexOp::notWordBoundary:
+		case RegexOp::wordStart:
+		case RegexOp::wordEnd:
+			if (Assertion(instruction.op, chPrevious, ch)) {
+				stack.push_back({ frame.pc + 1, -1, 0 });
+			}
+			break;
+		default:
+			std::copy(work.begin(), work.end(), list.captures.begin() + index * slots);
+			break;
+		}
+	}
+}
+
+Sci::Position LinearRegex::FindPrefix(const SplitView &text, Sci::Position start, Sci::Position end) const noexcept {
+	const Sci::Position length = prefix.length();
+	const char chFirst = prefix.front();
+	Sci::Position position = start;
+	while (position + length <= end) {
+		// memchr within whichever segment position is in
+		const size_t segmentEnd = (static_cast<size_t>(position) < text.length1) ? text.length1 : end;
+		const char *segment = (static_cast<size_t>(position) < text.length1) ? text.segment1 : text.segment2;
+		const size_t limit = std::min<size_t>(segmentEnd, end - length + 1);
+		if (static_cast<size_t>(position) >= limit) {
+			position = segmentEnd;
+			continue;
+		}
+		const char *found = static_cast<const char *>(memchr(segment + position, chFirst, limit - position));
+		if (!found) {
+			position = limit;
+			continue;
+		}
+		position = found - segment;
+		Sci::Position i = 1;
+		while (i < length && text.CharAt(position + i) == prefix[i]) {
+			i++;
+		}
+		if (i == length) {
+			return position;
+		}
+		position++;
+	}
+	return -1;
+}
+
+bool LinearRegex::Find(const SplitView &text, Sci::Position start, Sci::Position end, Captures &captures) {
+	ThreadList *current = &threads[0];
+	ThreadList *next = &threads[1];
+	current->count = 0;
+	const std::vector<Sci::Position> unset(slots, -1);
+	bool matched = false;
+	Sci::Position position = start;
+	int chPrevious = DecodeBefore(text, position, codePage);
+	for (;;) {
+		if (!matched && current->count == 0 && !prefix.empty()) {
+			const Sci::Position candidate = FindPrefix(text, position, end);
+			if (candidate < 0) {
+				break;
+			}
+			if (candidate != position) {
+				position = candidate;
+				chPrevious = DecodeBefore(text, position, codePage);
+			}
+		}
+		const Decoded decoded = DecodeAt(text, position, codePage);
+		if (!matched) {
+			// Lowest priority so earlier starts are preferred
+			AddThread(*current, 0, position, chPrevious, decoded.ch, unset.data());
+		}
+		if (current->count == 0 && matched) {
+			break;
+		}
+		const bool consume = position < end;
+		const Sci::Position positionNext = position + decoded.width;
+		const int chFolded = consume ? Fold(decoded.ch) : noCharacter;
+		int chNext = noCharacter;
+		bool decodedNext = false;
+		next->count = 0;
+		for (size_t i = 0; i < current->count; i++) {
+			const int pc = current->dense[i];
+			const RegexInstruction &instruction = program[pc];
+			bool step = false;
+			switch (instruction.op) {
+			case RegexOp::character:
+				step = consume && chFolded == instruction.arg;
+				break;
+			case RegexOp::any:
+				step = consume && decoded.ch != '\r' && decoded.ch != '\n';
+				break;
+			case RegexOp::set:
+				step = consume && SetContainsCase(sets[instruction.arg], decoded.ch);
+				break;
+			case RegexOp::match:
+				matched = true;
+				std::fill(captures.begin(), captures.end(), -1);
+				std::copy_n(current->captures.begin() + i * slots, slots, captures.begin());
+				// Threads after this one have lower priority
+				i = current->count;
+				break;
+			default:
+				break;
+			}
+			if (step) {
+				if (!decodedNext) {
+					chNext = DecodeAt(text, positionNext, codePage).ch;
+					decodedNext = true;
+				}
+				AddThread(*next, pc + 1, positionNext, decoded.ch, chNext, &current->captures[i * slots]);
+			}
+		}
+		if (!consume) {
+			break;
+		}
+		std::swap(current, next);
+		chPrevious = decoded.ch;
+		position = positionNext;
+	}
+	return matched;
+}
@@ -0,0 +1,98 @@
+// Scintilla source code edit control
+/** @file LinearRegex.h
+ ** Regular expression search in time linear to the length of the text.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef LINEARREGEX_H
+#define LINEARREGEX_H
+
+namespace Scintilla::Internal {
+
+enum class RegexOp : unsigned char {
+	character, any, set, split, jump, save,
+	lineStart, lineEnd, wordBoundary, notWordBoundary, wordStart, wordEnd,
+	match
+};
+
+struct RegexInstruction {
+	RegexOp op;
+	int arg;	// character, set index, save slot, preferred branch or jump target
+	int arg2;	// other branch of split
+};
+
+struct RegexCharacterSet {
+	enum { digit = 1, notDigit = 2, word = 4, notWord = 8, space = 16, notSpace = 32 };
+	std::vector<std::pair<int, int>> ranges;
+	int classes = 0;
+	bool negated = false;
+};
+
+/**
+ * Regular expression compiled to an NFA and run as a Pike VM directly over a SplitView.
+ * All alternatives advance together a character at a time so no pattern backtracks,
+ * and when no thread is alive a required literal prefix is searched for to skip ahead.
+ * Syntax: literals, . [] [^] [:class:] \d \D \w \W \s \S \xHH, ^ $ \b \B \< \>,
+ * (groups) (?:non capturing) | and greedy or lazy * + ? {n} {n,} {n,m}.
+ * ^ and $ match at every line start and end.
+ */
+class LinearRegex {
+public:
+	static constexpr int maxGroups = 10;
+	using Captures = std::array<Sci::Position, maxGroups * 2>;
+
+	/// Throws std::runtime_error for a malformed pattern.
+	LinearRegex(std::string_view pattern_, bool caseSensitive_, int codePage_, const CharClassify *charClass_);
+
+	bool SameAs(std::string_view pattern_, bool caseSensitive_, int codePage_) const noexcept;
+
+	/// Leftmost match starting at or after start and ending at or before end.
+	/// Text outside the range is only examined by assertions.
+	bool Find(const SplitView &text, Sci::Position start, Sci::Position end, Captures &captures);
+
+private:
+	struct ThreadList {
+		std::vector<int> sparse;
+		std::vector<int> dense;
+		std::vector<Sci::Position> captures;
+		size_t count = 0;
+		bool Contains(int pc) const noexcept {
+			const size_t index = sparse[pc];
+			return index < count && dense[index] == pc;
+		}
+		size_t Add(int pc) {
+			sparse[pc] = static_cast<int>(count);
+			dense[count] = pc;
+			return count++;
+		}
+	};
+	struct Frame {
+		int pc;
+		int slot;
+		Sci::Position value;
+	};
+
+	std::string pattern;
+	bool caseSensitive;
+	int codePage;
+	const CharClassify *charClass;
+	std::vector<RegexInstruction> program;
+	std::vector<RegexCharacterSet> sets;
+	std::string prefix;
+	int slots = 2;
+	ThreadList threads[2];
+	std::vector<Frame> stack;
+	std::vector<Sci::Position> work;
+
+	int Fold(int ch) const;
+	bool IsWord(int ch) const noexcept;
+	bool SetContains(const RegexCharacterSet &set, int ch) const;
+	bool SetContainsCase(const RegexCharacterSet &set, int ch) const;
+	bool Assertion(RegexOp op, int chPrevious, int ch) const noexcept;
+	void AddThread(ThreadList &list, int pc, Sci::Position position, int chPrevious, int ch, const Sci::Position *from);
+	Sci::Position FindPrefix(const SplitView &text, Sci::Position start, Sci::Position end) const noexcept;
+};
+
+}
+
+#endif
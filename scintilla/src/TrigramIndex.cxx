@@ -0,0 +1,306 @@
+// Scintilla source code edit control
+/** @file TrigramIndex.cxx
+ ** Index of the byte trigrams in each block of a document to narrow searches.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <memory>
+
+#include "ScintillaTypes.h"
+#include "ILoader.h"
+#include "ILexer.h"
+
+#include "Debugging.h"
+
+#include "CharacterType.h"
+#include "CharacterCategoryMap.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "TrigramIndex.h"
+#include "UniConversion.h"
+
+using namespace Scintilla;
+using namespace Scintilla::Internal;
+
+namespace {
+
+constexpr unsigned int trigramMask = 0xFFFFFF;
+constexpr size_t minimumBits = 0x200;
+constexpr size_t maximumBits = 0x10000;
+// Without a budget the index is a sixteenth of the text
+constexpr size_t defaultBytesPerBlock = TrigramIndex::blockSize / 16;
+
+constexpr unsigned int Fold(unsigned char ch) noexcept {
+	return MakeLowerCase(ch);
+}
+
+// Add range to ranges which are in order and do not overlap
+void MergeRange(std::vector<Range> &ranges, Range range) {
+	auto first = std::find_if(ranges.begin(), ranges.end(), [&range](const Range &r) noexcept {
+		return r.end >= range.start;
+	});
+	auto last = first;
+	while (last != ranges.end() && last->start <= range.end) {
+		range.start = std::min(range.start, last->start);
+		range.end = std::max(range.end, last->end);
+		++last;
+	}
+	ranges.insert(ranges.erase(first, last), range);
+}
+
+}
+
+TrigramQuery::TrigramQuery(std::string_view text, bool caseSensitive_) :
+	length(text.length()), caseSensitive(caseSensitive_), usable(false) {
+	if (text.length() < 3) {
+		return;
+	}
+	if (!caseSensitive && !std::all_of(text.begin(), text.end(), [](char ch) noexcept { return UTF8IsAscii(ch); })) {
+		return;
+	}
+	unsigned int trigram = (Fold(text[0]) << 8) | Fold(text[1]);
+	for (size_t i = 2; i < text.length(); i++) {
+		trigram = ((trigram << 8) | Fold(text[i])) & trigramMask;
+		trigrams.push_back(trigram);
+	}
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+	usable = true;
+}
+
+TrigramIndex::TrigramIndex(Sci::Position length, size_t memoryBudget) : starts(8) {
+	const Sci::Position blocks = std::max<Sci::Position>((length + blockSize - 1) / blockSize, 1);
+	size_t bitsPerBlock = memoryBudget ? memoryBudget * 8 / blocks : defaultBytesPerBlock * 8;
+	bitsPerBlock = std::clamp(bitsPerBlock, minimumBits, maximumBits);
+	// Round down to a power of 2 so the top bits of the hash select the bit
+	int log2 = 0;
+	while ((static_cast<size_t>(2) << log2) <= bitsPerBlock) {
+		log2++;
+	}
+	shift = 32 - log2;
+	wordsPerBlock = (static_cast<size_t>(1) << log2) / 64;
+
+	starts.InsertText(0, length);
+	for (Sci::Position block = 1; block < blocks; block++) {
+		starts.InsertPartition(block, block * blockSize);
+	}
+	bits.resize(blocks * wordsPerBlock);
+	nonASCII.resize(blocks);
+}
+
+Sci::Position TrigramIndex::Blocks() const noexcept {
+	return starts.Partitions();
+}
+
+size_t TrigramIndex::MemoryUse() const noexcept {
+	return bits.size() * sizeof(uint64_t) + nonASCII.size() + starts.Partitions() * sizeof(Sci::Position);
+}
+
+size_t TrigramIndex::Bit(unsigned int trigram) const noexcept {
+	// Fibonacci hashing spreads the similar trigrams of text over the filter
+	return static_cast<uint32_t>(trigram * 2654435769U) >> shift;
+}
+
+Sci::Position TrigramIndex::BlockLength(Sci::Position block) const noexcept {
+	return starts.PositionFromPartition(block + 1) - starts.PositionFromPartition(block);
+}
+
+// Add the trigrams starting in [start, end) which must all be in block
+void TrigramIndex::AddBlockTrigrams(const SplitView &text, Sci::Position block, Sci::Position start, Sci::Position end) noexcept {
+	const Sci::Position last = std::min<Sci::Position>(end, text.length - 2);
+	if (start >= last) {
+		return;
+	}
+	uint64_t *words = &bits[block * wordsPerBlock];
+	unsigned char ch0 = text.CharAt(start);
+	unsigned char ch1 = text.CharAt(start + 1);
+	unsigned int seen = ch0 | ch1;
+	unsigned int trigram = (Fold(ch0) << 8) | Fold(ch1);
+	for (Sci::Position position = start; position < last; position++) {
+		const unsigned char ch = text.CharAt(position + 2);
+		seen |= ch;
+		trigram = ((trigram << 8) | Fold(ch)) & trigramMask;
+		const size_t bit = Bit(trigram);
+		words[bit / 64] |= static_cast<uint64_t>(1) << (bit % 64);
+	}
+	if (seen & 0x80) {
+		nonASCII[block] = 1;
+	}
+}
+
+void TrigramIndex::AddTrigrams(const SplitView &text, Sci::Position start, Sci::Position end) noexcept {
+	Sci::Position block = starts.PartitionFromPosition(start);
+	while (start < end && block < starts.Partitions()) {
+		const Sci::Position blockEnd = std::min(end, starts.PositionFromPartition(block + 1));
+		AddBlockTrigrams(text, block, start, blockEnd);
+		start = std::max(start, blockEnd);
+		block++;
+	}
+}
+
+void TrigramIndex::BuildBlocks(const SplitView &text, Sci::Position first, Sci::Position last) noexcept {
+	for (Sci::Position block = first; block < last; block++) {
+		std::fill_n(bits.begin() + block * wordsPerBlock, wordsPerBlock, 0);
+		nonASCII[block] = 0;
+		AddBlockTrigrams(text, block, starts.PositionFromPartition(block), starts.PositionFromPartition(block + 1));
+	}
+}
+
+void TrigramIndex::SplitBlock(const SplitView &text, Sci::Position block) {
+	const Sci::Position start = starts.PositionFromPartition(block);
+	const Sci::Position pieces = BlockLength(block) / blockSize;
+	for (Sci::Position piece = 1; piece < pieces; piece++) {
+		starts.InsertPartition(block + piece, start + piece * blockSize);
+	}
+	bits.insert(bits.begin() + (block + 1) * wordsPerBlock, (pieces - 1) * wordsPerBlock, 0);
+	nonASCII.insert(nonASCII.begin() + block + 1, pieces - 1, 0);
+	BuildBlocks(text, block, block + pieces);
+}
+
+void TrigramIndex::RemoveBlock(Sci::Position block) {
+	// The empty block's start is removed so the following block takes over
+	// except for the first block whose start is fixed at 0.
+	starts.RemovePartition(block ? block : 1);
+	bits.erase(bits.begin() + block * wordsPerBlock, bits.begin() + (block + 1) * wordsPerBlock);
+	nonASCII.erase(nonASCII.begin() + block);
+}
+
+void TrigramIndex::InsertText(const SplitView &text, Sci::Position position, Sci::Position insertLength) {
+	const Sci::Position block = starts.PartitionFromPosition(position);
+	starts.InsertText(block, insertLength);
+	// New trigrams start up to two bytes before the insertion
+	AddTrigrams(text, std::max<Sci::Position>(position - 2, 0), position + insertLength);
+	if (BlockLength(block) >= 2 * blockSize) {
+		SplitBlock(text, block);
+	}
+}
+
+void TrigramIndex::DeleteText(const SplitView &text, Sci::Position position, Sci::Position deleteLength) {
+	if (deleteLength <= 0) {
+		return;
+	}
+	ShiftForDelete(position, deleteLength);
+	// Trigrams spanning the join
+	AddTrigrams(text, std::max<Sci::Position>(position - 2, 0), position);
+}
+
+void TrigramIndex::ShiftForDelete(Sci::Position position, Sci::Position deleteLength) {
+	const Sci::Position end = position + deleteLength;
+	const Sci::Position first = starts.PartitionFromPosition(position);
+	const Sci::Position last = starts.PartitionFromPosition(end - 1);
+	// From the end so each block's position is not yet affected
+	for (Sci::Position block = last; block >= first; block--) {
+		const Sci::Position overlap = std::min(end, starts.PositionFromPartition(block + 1)) -
+			std::max(position, starts.PositionFromPartition(block));
+		if (overlap > 0) {
+			starts.InsertText(block, -overlap);
+		}
+	}
+	for (Sci::Position block = last; block >= first; block--) {
+		if (starts.Partitions() > 1 && BlockLength(block) == 0) {
+			RemoveBlock(block);
+		}
+	}
+}
+
+void TrigramIndex::Replay(const SplitView &text, const std::vector<TrigramEdit> &edits) {
+	// Block boundaries follow each edit in turn while the ranges whose trigrams may have
+	// changed are tracked, the trigrams are only taken from the current text at the end
+	std::vector<Range> changed;
+	for (const TrigramEdit &edit : edits) {
+		if (edit.length > 0) {
+			starts.InsertText(starts.PartitionFromPosition(edit.position), edit.length);
+			for (Range &range : changed) {
+				if (range.start >= edit.position) {
+					range.start += edit.length;
+				}
+				if (range.end >= edit.position) {
+					range.end += edit.length;
+				}
+			}
+			MergeRange(changed, Range(std::max<Sci::Position>(edit.position - 2, 0), edit.position + edit.length));
+		} else if (edit.length < 0) {
+			ShiftForDelete(edit.position, -edit.length);
+			const auto moved = [&edit](Sci::Position pos) noexcept {
+				return (pos < edit.position) ? pos : std::max(edit.position, pos + edit.length);
+			};
+			for (Range &range : changed) {
+				range.start = moved(range.start);
+				range.end = moved(range.end);
+			}
+			MergeRange(changed, Range(std::max<Sci::Position>(edit.position - 2, 0), edit.position));
+		}
+	}
+	for (Sci::Position block = 0; block < starts.Partitions(); block++) {
+		if (BlockLength(block) >= 2 * blockSize) {
+			SplitBlock(text, block);
+		}
+	}
+	for (const Range &range : changed) {
+		if (range.start < range.end) {
+			BuildBlocks(text, starts.PartitionFromPosition(range.start), starts.PartitionFromPosition(range.end - 1) + 1);
+		}
+	}
+}
+
+bool TrigramIndex::MayStartMatch(const TrigramQuery &query, Sci::Position block) const noexcept {
+	// A match starting near the end of block takes its later trigrams from following blocks
+	const Sci::Position reach = starts.PositionFromPartition(block + 1) + query.length;
+	Sci::Position last = block;
+	while ((last + 1) < starts.Partitions() && starts.PositionFromPartition(last + 1) < reach) {
+		last++;
+	}
+	if (!query.caseSensitive) {
+		for (Sci::Position b = block; b <= last; b++) {
+			if (nonASCII[b]) {
+				return true;
+			}
+		}
+	}
+	for (const unsigned int trigram : query.trigrams) {
+		const size_t bit = Bit(trigram);
+		bool present = false;
+		for (Sci::Position b = block; b <= last && !present; b++) {
+			present = (bits[b * wordsPerBlock + bit / 64] >> (bit % 64)) & 1;
+		}
+		if (!present) {
+			return false;
+		}
+	}
+	return true;
+}
+
+Range TrigramIndex::Candidates(const TrigramQuery &query, Sci::Position position, Sci::Position end) const noexcept {
+	const Sci::Position blocks = starts.Partitions();
+	Sci::Position block = starts.PartitionFromPosition(position);
+	while (block < blocks && starts.PositionFromPartition(block) < end && !MayStartMatch(query, block)) {
+		block++;
+	}
+	if (block >= blocks || starts.PositionFromPartition(block) >= end) {
+		return Range(end);
+	}
+	Sci::Position next = block + 1;
+	while (next < blocks && starts.PositionFromPartition(next) < end && MayStartMatch(query, next)) {
+		next++;
+	}
+	return Range(std::max(position, starts.PositionFromPartition(block)),
+		std::min(end, starts.PositionFromPartition(next)));
+}
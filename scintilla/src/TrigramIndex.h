@@ -0,0 +1,84 @@
+// Scintilla source code edit control
+/** @file TrigramIndex.h
+ ** Index of the byte trigrams in each block of a document to narrow searches.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+namespace Scintilla::Internal {
+
+/**
+ * The trigrams of a search string folded the same way as the index.
+ * Case insensitive matching can fold non-ASCII text onto ASCII so only
+ * case sensitive or all ASCII searches can be narrowed.
+ */
+class TrigramQuery {
+public:
+	std::vector<unsigned int> trigrams;
+	Sci::Position length;
+	bool caseSensitive;
+	bool usable;
+	TrigramQuery(std::string_view text, bool caseSensitive_);
+};
+
+/**
+ * An edit made after the text an index is built from was taken, a negative length is a deletion.
+ */
+struct TrigramEdit {
+	Sci::Position position;
+	Sci::Position length;
+};
+
+/**
+ * A Bloom filter per block of the trigrams starting in that block with ASCII letters lower cased.
+ * Edits only ever add trigrams so a block may become a false candidate but never hides a match.
+ * Blocks are kept in a Partitioning so edits shift following blocks cheaply and
+ * blocks that grow too large are split and rebuilt.
+ */
+class TrigramIndex {
+public:
+	static constexpr Sci::Position blockSize = 0x10000;
+
+	TrigramIndex(Sci::Position length, size_t memoryBudget);
+
+	Sci::Position Blocks() const noexcept;
+	size_t MemoryUse() const noexcept;
+
+	/// Fill blocks [first, last). Distinct blocks may be built on different threads
+	/// as long as text does not change.
+	void BuildBlocks(const SplitView &text, Sci::Position first, Sci::Position last) noexcept;
+
+	/// Called after the document text has changed.
+	void InsertText(const SplitView &text, Sci::Position position, Sci::Position insertLength);
+	void DeleteText(const SplitView &text, Sci::Position position, Sci::Position deleteLength);
+
+	/// Catch up with the edits made to the text since it was given to BuildBlocks,
+	/// text is the current text. The blocks the edits touched are built again.
+	void Replay(const SplitView &text, const std::vector<TrigramEdit> &edits);
+
+	/// First run of blocks in [position, end) where a match of query may start,
+	/// an empty range at end when there is none.
+	Range Candidates(const TrigramQuery &query, Sci::Position position, Sci::Position end) const noexcept;
+
+private:
+	Partitioning<Sci::Position> starts;
+	int shift;
+	size_t wordsPerBlock;
+	std::vector<uint64_t> bits;
+	std::vector<unsigned char> nonASCII;
+
+	size_t Bit(unsigned int trigram) const noexcept;
+	Sci::Position BlockLength(Sci::Position block) const noexcept;
+	void AddBlockTrigrams(const SplitView &text, Sci::Position block, Sci::Position start, Sci::Position end) noexcept;
+	void AddTrigrams(const SplitView &text, Sci::Position start, Sci::Position end) noexcept;
+	void SplitBlock(const SplitView &text, Sci::Position block);
+	void RemoveBlock(Sci::Position block);
+	void ShiftForDelete(Sci::Position position, Sci::Position deleteLength);
+	bool MayStartMatch(const TrigramQuery &query, Sci::Position block) const noexcept;
+};
+
+}
+
+#endif
@@ -29,6 +29,7 @@ struct _GtkScintillaClass
 
 	// signals
 	void(*text_changed)(GtkScintilla* self);
+	void(*changes)(GtkScintilla* self, GArray* changes, gint64 firstLine, gint64 lastLine);
 };
 
 enum
@@ -40,11 +41,24 @@ enum
 	PROP_EDITABLE,
 	PROP_LINES,
 	PROP_LINE_NUMBER,
+	PROP_LINE_NUMBER_MAX_LINES,
 	PROP_FOLD,
 	PROP_AUTO_INDENT,
 	PROP_INDENT_GUIDES,
 	PROP_TAB_WIDTH,
 	PROP_WRAP_MODE,
+	PROP_SEARCH_INDEX,
+	PROP_SEARCH_INDEX_BUDGET,
+	PROP_RESTYLE_PROGRESS,
+	PROP_MOD_EVENT_MASK,
+	PROP_LOG_MODE,
+	PROP_LOG_MAX_LINES,
+	PROP_APPEND_BUDGET,
+	PROP_LAYOUT_THREADS,
+	PROP_IDLE_STYLING,
+	PROP_LAYOUT_CACHE,
+	PROP_POSITION_CACHE,
+	PROP_PERFORMANCE_PROFILE,
 	PROP_COUNT
 };
 
@@ -53,6 +67,7 @@ static GParamSpec* props[PROP_COUNT];
 enum
 {
 	SIGNAL_TEXT_CHANGED,
+	SIGNAL_CHANGES,
 	SIGNAL_COUNT
 };
 
@@ -61,20 +76,54 @@ static guint signals[SIGNAL_COUNT];
 typedef struct _ScintillaStyle ScintillaStyle;
 typedef struct _ScintillaFont ScintillaFont;
 typedef struct _ScintillaLanguage ScintillaLanguage;
+typedef struct _GtkScintillaSearch GtkScintillaSearch;
+typedef struct _GtkScintillaAppendRing GtkScintillaAppendRing;
+typedef struct _GtkScintillaDocState GtkScintillaDocState;
+
+#define GSCI_MARGIN_DIGITS_MAX 10
 
 typedef struct _GtkScintillaPrivate
 {
 	ScintillaObject* sci;
 	const ScintillaStyle* style;
-	const ScintillaLanguage* lang;
-	gintptr searchPos;
+	GtkScintillaDocState* docState;
 	guint lines;
+	guint lineNumberMaxLines;
+	int marginDigits;
+	int marginWidths[GSCI_MARGIN_DIGITS_MAX + 1];
+	guint64 searchIndexBudget;
+	gpointer indexDoc;
+	gpointer terms;
+	int* termIndicators;
+	guint termCount;
+	guint termIdle;
+	GArray* termPending;
+	guint restyleTimer;
+	gintptr restyleEnd;
+	GArray* changes;
+	gint64 changeFirstLine;
+	gint64 changeLastLine;
+	guint changesTick;
+	guint changesTimer;
+	guint modEventMask;
+	GString* logPending;
+	guint logMaxLines;
+	int logChangeHistory;
+	guint logTick;
+	guint logTimer;
+	GtkScintillaAppendRing* appendRing;
+	gintptr searchPos;
+	GPtrArray* searches;
 	GtkWrapMode wrapMode;
+	guint tuneBucket;
 	gboolean dark : 1;
 	gboolean fold : 1;
 	gboolean lineNumber : 1;
 	gboolean autoIndent : 1;
-	gboolean editable : 1;
+	gboolean searchIndex : 1;
+	gboolean lexer : 1;
+	gboolean logMode : 1;
+	gboolean tuned : 1;
 
 } GtkScintillaPrivate;
 
@@ -90,6 +139,19 @@ G_DEFINE_TYPE_WITH_PRIVATE(GtkScintilla, gtk_scintilla, SCINTILLA_TYPE_OBJECT)
 #define GSCI_FOLD_MARGIN_WIDTH 12
 #define GSCI_CARET_WIDTH 2
 #define GSCI_LINE_FRAME_WIDTH 2
+#define GSCI_INDICATOR_FIND INDICATOR_CONTAINER
+#define GSCI_RESTYLE_INTERVAL 100
+#define GSCI_CHANGES_INTERVAL 16
+#define GSCI_MOD_EVENTS_REQUIRED (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT)
+#define GSCI_TUNE_LARGE_DOCUMENT (1 << 20)
+#define GSCI_TUNE_STYLE_SECONDS 2.0
+#define GSCI_TUNE_WRAP_SECONDS 0.05
+#define GSCI_TUNE_DOCUMENT_CACHE_LINES 200000
+#define GSCI_TUNE_HYSTERESIS 1.5
+#define GSCI_POSITION_CACHE 1024
+#define GSCI_POSITION_CACHE_LARGE 4096
+#define GSCI_LOG_INTERVAL 16
+#define GSCI_APPEND_BUDGET (4 << 20)
 
 #define SSM(sci, msg, wp, lp) scintilla_send_message(SCINTILLA(sci), msg, (uptr_t)wp, (uptr_t)lp)
 #define RGB(r, g, b) ((guint32(b) << 16) | (guint32(g) << 8) | guint32(r))
@@ -161,14 +223,43 @@ static const ScintillaLanguage GSCI_LANGUAGES[] =
 	{ NULL }
 };
 
+static void captureStyleBase(ScintillaObject* sci);
 static void updateStyle(GtkScintillaPrivate* priv);
+static void updateLexer(GtkScintilla* self);
+static void updateDocumentLexer(GtkScintilla* self);
 static void updateFold(GtkScintillaPrivate* priv);
 static void updateLineNumber(GtkScintilla* sci);
+static void resetLineNumberWidths(GtkScintillaPrivate* priv);
+static void attachDocument(GtkScintilla* self, gpointer doc);
+static void docStateJoin(GtkScintilla* self, gpointer doc);
+static void docStateLeave(GtkScintilla* self);
+static void updateSearchIndex(GtkScintilla* self);
+static void restyleStart(GtkScintilla* self);
+static void termRestart(GtkScintilla* self);
+static void termEdited(GtkScintilla* self, int mod, gintptr pos, gintptr length);
+static void sessionRestart(GtkScintillaSearch* search);
+static void sessionEdited(GtkScintillaSearch* search, int mod, gintptr pos, gintptr length);
+static void setReadOnly(GtkScintillaPrivate* priv, gboolean readOnly);
+static void changesAdd(GtkScintilla* self, int mod, gintptr pos, gintptr length, gintptr linesAdded);
+static void changesFlush(GtkScintilla* self);
+static void changesDrop(GtkScintilla* self);
+static void changesSchedule(GtkScintilla* self);
+static void logSchedule(GtkScintilla* self);
+static void logDrop(GtkScintilla* self);
+static void logConfigHistory(GtkScintilla* self);
+static void onUnmap(GtkScintilla* self, gpointer data);
+static void tune(GtkScintilla* self);
+static GtkScintillaAppendRing* ringNew(GtkScintilla* self);
+static void ringClose(GtkScintillaAppendRing* ring);
+static void ringUnref(gpointer p);
+static void ringSetPending(GtkScintillaAppendRing* ring, gsize pending);
 static void onSciNotify(GtkScintilla* self, gint param, SCNotification* notif, GtkScintillaPrivate* priv);
 
 static void gtk_scintilla_class_install_properties(GtkScintillaClass* klass);
 static void gtk_scintilla_class_install_signals(GtkScintillaClass* klass);
 
+static void gtk_scintilla_dispose(GObject* obj);
+static void gtk_scintilla_finalize(GObject* obj);
 static void gtk_scintilla_get_property(GObject* obj, guint prop, GValue* val, GParamSpec* ps);
 static void gtk_scintilla_set_property(GObject* obj, guint prop, const GValue* val, GParamSpec* ps);
 
@@ -176,6 +267,8 @@ static void gtk_scintilla_class_init(GtkScintillaClass* klass)
 {
 	GObjectClass* cls = G_OBJECT_CLASS(klass);
 
+	cls->dispose = gtk_scintilla_dispose;
+	cls->finalize = gtk_scintilla_finalize;
 	cls->get_property = gtk_scintilla_get_property;
 	cls->set_property = gtk_scintilla_set_property;
 
@@ -190,20 +283,59 @@ static void gtk_scintilla_init(GtkScintilla* sci)
 	GtkScintillaPrivate* priv = PRIVATE(sci);
 	priv->sci = SCINTILLA(sci);
 	priv->style = &GSCI_STYLES[0];
-	priv->lang = &GSCI_LANGUAGES[0];
+	priv->docState = NULL;
 	priv->wrapMode = GTK_WRAP_NONE;
+	priv->tuneBucket = 0;
 	priv->lines = 0;
+	priv->lineNumberMaxLines = 0;
+	priv->marginDigits = 0;
+	memset(priv->marginWidths, 0, sizeof(priv->marginWidths));
+	priv->searchIndexBudget = 0;
+	priv->indexDoc = NULL;
+	priv->terms = NULL;
+	priv->termIndicators = NULL;
+	priv->termCount = 0;
+	priv->termIdle = 0;
+	priv->termPending = NULL;
+	priv->restyleTimer = 0;
+	priv->restyleEnd = 0;
+	priv->changes = NULL;
+	priv->changeFirstLine = 0;
+	priv->changeLastLine = 0;
+	priv->changesTick = 0;
+	priv->changesTimer = 0;
+	priv->modEventMask = SC_MODEVENTMASKALL;
+	priv->logPending = NULL;
+	priv->logMaxLines = 0;
+	priv->logChangeHistory = SC_CHANGE_HISTORY_DISABLED;
+	priv->logTick = 0;
+	priv->logTimer = 0;
+	priv->appendRing = ringNew(sci);
 	priv->searchPos = -1;
+	priv->searches = g_ptr_array_new();
 	priv->dark = false;
 	priv->fold = false;
 	priv->lineNumber = false;
 	priv->autoIndent = false;
-	priv->editable = true;
+	priv->searchIndex = false;
+	priv->lexer = false;
+	priv->logMode = false;
+	priv->tuned = false;
 
 	SSM(sci, SCI_SETBUFFEREDDRAW, 0, 0); // disable buffered draw
 	SSM(sci, SCI_SETEOLMODE, SC_EOL_LF, 0); // set EOL LF(\n)
+	SSM(sci, SCI_SETIDLESTYLING, SC_IDLESTYLING_ALL, 0); // style beyond the visible lines in idle time
+
+	SSM(sci, SCI_INDICSETSTYLE, GSCI_INDICATOR_FIND, INDIC_ROUNDBOX);
+	SSM(sci, SCI_INDICSETFORE, GSCI_INDICATOR_FIND, HEX_RGB(0xFFD700));
+	SSM(sci, SCI_INDICSETALPHA, GSCI_INDICATOR_FIND, 100);
+	SSM(sci, SCI_INDICSETUNDER, GSCI_INDICATOR_FIND, TRUE);
+
+	captureStyleBase(priv->sci);
+	docStateJoin(sci, (gpointer)SSM(sci, SCI_GETDOCPOINTER, 0, 0));
 
 	g_signal_connect(SCINTILLA(sci), "sci-notify", G_CALLBACK(onSciNotify), priv);
+	g_signal_connect(sci, "unmap", G_CALLBACK(onUnmap), NULL);
 }
 
 EXPORT GtkWidget* gtk_scintilla_new(void)
@@ -250,22 +382,24 @@ EXPORT void gtk_scintilla_set_style(GtkScintilla* self, const char* styleName)
 EXPORT const char* gtk_scintilla_get_language(GtkScintilla* sci)
 {
 	GtkScintillaPrivate* priv = PRIVATE(sci);
-	if (priv->lang)
-		return priv->lang->language;
+	if (priv->docState)
+		return priv->docState->lang->language;
 	return "";
 }
 
+// the language belongs to the document, every view showing it is restyled
 EXPORT void gtk_scintilla_set_language(GtkScintilla* self, const char* language)
 {
-	GtkScintillaPrivate* priv = PRIVATE(self);
-	priv->lang = &GSCI_LANGUAGES[0]; // default
+	GtkScintillaDocState* state = PRIVATE(self)->docState;
+	state->lang = &GSCI_LANGUAGES[0]; // default
 	for (const ScintillaLanguage* lang = &GSCI_LANGUAGES[0]; lang->language != NULL; lang++)
 	{
 		if (strcmp(lang->language, language) == 0)
 		{
-			priv->lang = lang;
-			updateStyle(priv);
-			g_object_notify_by_pspec(G_OBJECT(self), props[PROP_LANGUAGE]);
+			state->lang = lang;
+			updateDocumentLexer(self);
+			for (guint i = 0; i < state->views->len; i++)
+				g_object_notify_by_pspec(g_ptr_array_index(state->views, i), props[PROP_LANGUAGE]);
 			return;
 		}
 	}
@@ -274,15 +408,18 @@ EXPORT void gtk_scintilla_set_language(GtkScintilla* self, const char* language)
 EXPORT gboolean gtk_scintilla_get_editable(GtkScintilla* self)
 {
 	GtkScintillaPrivate* priv = PRIVATE(self);
-	return priv->editable;
+	return !priv->docState || priv->docState->editable;
 }
 
+// read-only is stored in the document, every view showing it follows
 EXPORT void gtk_scintilla_set_editable(GtkScintilla* self, gboolean enb)
 {
 	GtkScintillaPrivate* priv = PRIVATE(self);
-	priv->editable = enb;
-	SSM(self, SCI_SETREADONLY, !enb, 0);
-	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_EDITABLE]);
+	GtkScintillaDocState* state = priv->docState;
+	state->editable = !!enb;
+	setReadOnly(priv, !enb);
+	for (guint i = 0; i < state->views->len; i++)
+		g_object_notify_by_pspec(g_ptr_array_index(state->views, i), props[PROP_EDITABLE]);
 }
 
 EXPORT gboolean gtk_scintilla_get_line_number(GtkScintilla* self)
@@ -303,10 +440,37 @@ EXPORT void gtk_scintilla_set_line_number(GtkScintilla* self, gboolean enb)
 	else
 	{
 		SSM(self, SCI_SETMARGINWIDTHN, GSCI_NUMBER_MARGIN_INDEX, 0);
+		priv->marginDigits = 0;
 	}
 	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_LINE_NUMBER]);
 }
 
+EXPORT guint gtk_scintilla_get_line_number_max_lines(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	return priv->lineNumberMaxLines;
+}
+
+// sizes the line number margin for this many lines up front so it keeps its width while text streams in,
+// it still grows past them, 0 fits the margin to the line count
+EXPORT void gtk_scintilla_set_line_number_max_lines(GtkScintilla* self, guint lines)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	priv->lineNumberMaxLines = lines;
+	updateLineNumber(self);
+	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_LINE_NUMBER_MAX_LINES]);
+}
+
+// share of the document lexed since the last language change, 1 once styling is complete
+EXPORT gdouble gtk_scintilla_get_restyle_progress(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	gintptr length = SSM(self, SCI_GETLENGTH, 0, 0);
+	if (!priv->lexer || length == 0)
+		return 1.0;
+	return (gdouble)SSM(self, SCI_GETENDSTYLED, 0, 0) / length;
+}
+
 EXPORT guint gtk_scintilla_get_lines(GtkScintilla* self)
 {
 	GtkScintillaPrivate* priv = PRIVATE(self);
@@ -375,9 +539,92 @@ EXPORT void gtk_scintilla_set_wrap_mode(GtkScintilla* sci, GtkWrapMode mode)
 	default:
 		return;
 	}
+	tune(sci);
 	g_object_notify_by_pspec(G_OBJECT(sci), props[PROP_WRAP_MODE]);
 }
 
+// language and read-only state of a document shared by every view showing it
+struct _GtkScintillaDocState
+{
+	gpointer doc;
+	GPtrArray* views;
+	const ScintillaLanguage* lang;
+	gboolean editable;
+};
+
+static GHashTable* documentStates = NULL;
+
+void docStateLeave(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	GtkScintillaDocState* state = priv->docState;
+	priv->docState = NULL;
+	if (!state)
+		return;
+
+	g_ptr_array_remove(state->views, self);
+	if (state->views->len > 0)
+		return;
+	g_hash_table_remove(documentStates, state->doc);
+	g_ptr_array_unref(state->views);
+	g_free(state);
+}
+
+// a document no other view shows yet keeps the language and read-only state the view had
+void docStateJoin(GtkScintilla* self, gpointer doc)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	GtkScintillaDocState* old = priv->docState;
+	if (old && old->doc == doc)
+		return;
+
+	if (!documentStates)
+		documentStates = g_hash_table_new(g_direct_hash, g_direct_equal);
+	GtkScintillaDocState* state = g_hash_table_lookup(documentStates, doc);
+	if (!state)
+	{
+		state = g_new0(GtkScintillaDocState, 1);
+		state->doc = doc;
+		state->views = g_ptr_array_new();
+		state->lang = old ? old->lang : &GSCI_LANGUAGES[0];
+		state->editable = old ? old->editable : TRUE;
+		g_hash_table_insert(documentStates, doc, state);
+	}
+	docStateLeave(self);
+	g_ptr_array_add(state->views, self);
+	priv->docState = state;
+}
+
+// another view of the document shown by other: text, undo history, styles and fold levels are shared and
+// lexed once, the selection, scroll position, folded lines and laid out lines stay per view
+EXPORT GtkWidget* gtk_scintilla_new_view_of(GtkScintilla* other)
+{
+	GtkScintillaPrivate* from = PRIVATE(other);
+	GtkWidget* widget = gtk_scintilla_new();
+	GtkScintilla* self = GTK_SCINTILLA(widget);
+	GtkScintillaPrivate* priv = PRIVATE(self);
+
+	priv->style = from->style;
+	priv->dark = from->dark;
+	priv->fold = from->fold;
+	priv->autoIndent = from->autoIndent;
+	priv->lexer = from->lexer;
+	priv->tuned = from->tuned;
+
+	// setting the document adds the reference of this view, the lexer, styles, language and read-only
+	// state come with it
+	gpointer doc = (gpointer)SSM(other, SCI_GETDOCPOINTER, 0, 0);
+	SSM(self, SCI_SETDOCPOINTER, 0, doc);
+	docStateJoin(self, doc);
+	setReadOnly(priv, !priv->docState->editable);
+	updateStyle(priv);
+	updateFold(priv);
+	gtk_scintilla_set_wrap_mode(self, from->wrapMode);
+	gtk_scintilla_set_indent_guides(self, gtk_scintilla_get_indent_guides(other));
+	gtk_scintilla_set_line_number(self, from->lineNumber);
+	return widget;
+}
+
 EXPORT guint gtk_scintilla_get_tab_width(GtkScintilla* sci)
 {
 	return (guint)SSM(sci, SCI_GETTABWIDTH, 0, 0);
@@ -389,20 +636,46 @@ EXPORT void gtk_scintilla_set_tab_width(GtkScintilla* sci, guint width)
 	g_object_notify_by_pspec(G_OBJECT(sci), props[PROP_TAB_WIDTH]);
 }
 
+EXPORT guint gtk_scintilla_get_mod_event_mask(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	return priv->modEventMask;
+}
+
+// SC_MOD_* events sent with sci-notify, insertions and deletions are always tracked for the widget itself
+EXPORT void gtk_scintilla_set_mod_event_mask(GtkScintilla* self, guint mask)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	priv->modEventMask = mask & SC_MODEVENTMASKALL;
+	SSM(self, SCI_SETMODEVENTMASK, priv->modEventMask | GSCI_MOD_EVENTS_REQUIRED | (priv->fold ? SC_MOD_CHANGEFOLD : 0), 0);
+	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_MOD_EVENT_MASK]);
+}
+
 EXPORT void gtk_scintilla_set_text(GtkScintilla* self, const char* text)
 {
 	GtkScintillaPrivate* priv = PRIVATE(self);
-	SSM(self, SCI_SETREADONLY, 0, 0);
+	logDrop(self);
+	setReadOnly(priv, FALSE);
 	SSM(self, SCI_SETTEXT, 0, text);
-	SSM(self, SCI_SETREADONLY, !priv->editable, 0);
+	setReadOnly(priv, !priv->docState->editable);
 }
 
+// in log mode the text is queued and appended with the rest of the frame's text
 EXPORT void gtk_scintilla_append_text(GtkScintilla* self, const char* text, gint64 length)
 {
 	GtkScintillaPrivate* priv = PRIVATE(self);
-	SSM(self, SCI_SETREADONLY, 0, 0);
+	if (priv->logMode)
+	{
+		if (!priv->logPending)
+			priv->logPending = g_string_new(NULL);
+		g_string_append_len(priv->logPending, text, length);
+		ringSetPending(priv->appendRing, priv->logPending->len);
+		logSchedule(self);
+		return;
+	}
+	setReadOnly(priv, FALSE);
 	SSM(self, SCI_APPENDTEXT, length, text);
-	SSM(self, SCI_SETREADONLY, !priv->editable, 0);
+	setReadOnly(priv, !priv->docState->editable);
 }
 
 EXPORT guint64 gtk_scintilla_get_text_length(GtkScintilla* sci)
@@ -418,17 +691,422 @@ EXPORT guint64 gtk_scintilla_get_text(GtkScintilla* sci, char* buf, guint64 leng
 EXPORT void gtk_scintilla_clear_text(GtkScintilla* self)
 {
 	GtkScintillaPrivate* priv = PRIVATE(self);
-	SSM(self, SCI_SETREADONLY, 0, 0);
+	logDrop(self);
+	setReadOnly(priv, FALSE);
 	SSM(self, SCI_CLEARALL, 0, 0);
-	SSM(self, SCI_SETREADONLY, !priv->editable, 0);
+	setReadOnly(priv, !priv->docState->editable);
 }
 
 EXPORT void gtk_scintilla_clear_undo_redo(GtkScintilla* self)
 {
 	GtkScintillaPrivate* priv = PRIVATE(self);
-	SSM(self, SCI_SETREADONLY, 0, 0);
+	setReadOnly(priv, FALSE);
+	SSM(self, SCI_EMPTYUNDOBUFFER, 0, 0);
+	setReadOnly(priv, !priv->docState->editable);
+}
+
+// borrowed text access
+
+typedef struct _GtkScintillaChunkIter
+{
+	gintptr pos;
+	gintptr end;
+	gintptr gap;
+} GtkScintillaChunkIter;
+
+EXPORT GBytes* gtk_scintilla_get_range_bytes(GtkScintilla* self, gintptr start, gintptr end)
+{
+	gintptr length = SSM(self, SCI_GETLENGTH, 0, 0);
+	if (end < 0 || end > length)
+		end = length;
+	start = CLAMP(start, 0, end);
+
+	// moving the gap of pinned text would copy the whole document, a range spanning it is
+	// copied instead while other bytes are lent out
+	gpointer doc = (gpointer)SSM(self, SCI_GETDOCPOINTER, 0, 0);
+	gintptr gap = SSM(self, SCI_GETGAPPOSITION, 0, 0);
+	if (start < gap && end > gap && scintilla_document_text_pinned(doc))
+	{
+		struct Sci_TextRangeFull range;
+		range.chrg.cpMin = start;
+		range.chrg.cpMax = end;
+		range.lpstrText = g_malloc(end - start + 1);
+		SSM(self, SCI_GETTEXTRANGEFULL, 0, &range);
+		return g_bytes_new_take(range.lpstrText, end - start);
+	}
+
+	// only moves the gap when the range spans it, then pins the text so edits leave it alone
+	const char* data = (const char*)SSM(self, SCI_GETRANGEPOINTER, start, end - start);
+	gpointer pin = scintilla_document_pin_text(doc);
+	if (!pin)
+		return g_bytes_new(data, end - start);
+	return g_bytes_new_with_free_func(data, end - start, scintilla_text_pin_release, pin);
+}
+
+EXPORT void gtk_scintilla_chunk_iter_init(GtkScintilla* self, GtkScintillaChunkIter* iter, gintptr start, gintptr end)
+{
+	gintptr length = SSM(self, SCI_GETLENGTH, 0, 0);
+	if (end < 0 || end > length)
+		end = length;
+	iter->pos = CLAMP(start, 0, end);
+	iter->end = end;
+	iter->gap = SSM(self, SCI_GETGAPPOSITION, 0, 0);
+}
+
+EXPORT gboolean gtk_scintilla_chunk_iter_next(GtkScintilla* self, GtkScintillaChunkIter* iter, const char** data, gsize* length)
+{
+	if (iter->pos >= iter->end)
+		return FALSE;
+
+	// stop at the gap so neither half is moved, it may have moved since the last chunk
+	iter->gap = SSM(self, SCI_GETGAPPOSITION, 0, 0);
+	gintptr end = iter->end;
+	if (iter->pos < iter->gap && end > iter->gap)
+		end = iter->gap;
+
+	*data = (const char*)SSM(self, SCI_GETRANGEPOINTER, iter->pos, end - iter->pos);
+	*length = end - iter->pos;
+	iter->pos = end;
+	return TRUE;
+}
+
+// async file saving
+
+#define GSCI_SAVE_BUFFER_SIZE (1 << 20)
+
+typedef struct _GtkScintillaSave
+{
+	GFile* file;
+	char* charset;
+	char* eol;
+	gpointer pin;
+	GOutputVector chunks[2];
+	guint count;
+} GtkScintillaSave;
+
+static void saveFree(gpointer p)
+{
+	GtkScintillaSave* save = p;
+	if (save->pin)
+		scintilla_text_pin_release(save->pin);
+	g_object_unref(save->file);
+	g_free(save->charset);
+	g_free(save->eol);
+	g_free(save);
+}
+
+static gboolean saveWriteEol(GOutputStream* out, const GtkScintillaSave* save, GCancellable* cancellable, GError** error)
+{
+	gsize eolLength = strlen(save->eol);
+	gboolean prevCR = FALSE;
+	for (guint i = 0; i < save->count; i++)
+	{
+		const char* p = save->chunks[i].buffer;
+		const char* end = p + save->chunks[i].size;
+
+		// CR LF split by the gap
+		if (prevCR && p < end && *p == '\n')
+			p++;
+		prevCR = FALSE;
+
+		while (p < end)
+		{
+			const char* q = p;
+			while (q < end && *q != '\r' && *q != '\n')
+				q++;
+
+			GOutputVector line[2] = { { p, q - p }, { save->eol, eolLength } };
+			if (!g_output_stream_writev_all(out, line, q < end ? 2 : 1, NULL, cancellable, error))
+				return FALSE;
+			if (q == end)
+				break;
+
+			if (*q == '\r')
+			{
+				if (q + 1 == end)
+					prevCR = TRUE;
+				else if (q[1] == '\n')
+					q++;
+			}
+			p = q + 1;
+		}
+	}
+	return TRUE;
+}
+
+static void saveFileThread(GTask* task, gpointer source, gpointer taskData, GCancellable* cancellable)
+{
+	GtkScintillaSave* save = taskData;
+	GError* error = NULL;
+
+	GFileOutputStream* file = g_file_replace(save->file, NULL, FALSE, G_FILE_CREATE_NONE, cancellable, &error);
+	if (!file)
+	{
+		g_task_return_error(task, error);
+		return;
+	}
+
+	GOutputStream* out = G_OUTPUT_STREAM(file);
+	if (save->charset)
+	{
+		GCharsetConverter* conv = g_charset_converter_new(save->charset, "UTF-8", &error);
+		if (!conv)
+		{
+			g_object_unref(out);
+			g_task_return_error(task, error);
+			return;
+		}
+		out = g_converter_output_stream_new(G_OUTPUT_STREAM(file), G_CONVERTER(conv));
+		g_object_unref(conv);
+		g_object_unref(file);
+	}
+
+	gboolean ok;
+	if (save->eol)
+	{
+		// line by line writes are gathered before reaching the file
+		GOutputStream* buffered = g_buffered_output_stream_new_sized(out, GSCI_SAVE_BUFFER_SIZE);
+		g_object_unref(out);
+		out = buffered;
+		ok = saveWriteEol(out, save, cancellable, &error);
+	}
+	else
+	{
+		// both halves of the gap buffer go out in one call
+		ok = g_output_stream_writev_all(out, save->chunks, save->count, NULL, cancellable, &error);
+	}
+
+	ok = ok && g_output_stream_close(out, cancellable, &error);
+	g_object_unref(out);
+
+	if (!ok)
+	{
+		g_task_return_error(task, error);
+		return;
+	}
+	g_task_return_boolean(task, TRUE);
+}
+
+EXPORT void gtk_scintilla_save_async(GtkScintilla* self, GFile* file, const char* charset, const char* eol,
+	GCancellable* cancellable, GAsyncReadyCallback callback, gpointer userData)
+{
+	GtkScintillaSave* save = g_new0(GtkScintillaSave, 1);
+	save->file = g_object_ref(file);
+	save->charset = g_strdup(charset);
+	save->eol = g_strdup(eol);
+
+	// the chunks are a snapshot, edits made while writing move the document to a copy
+	GtkScintillaChunkIter iter;
+	const char* data;
+	gsize length;
+	gtk_scintilla_chunk_iter_init(self, &iter, 0, -1);
+	while (gtk_scintilla_chunk_iter_next(self, &iter, &data, &length))
+	{
+		save->chunks[save->count].buffer = data;
+		save->chunks[save->count].size = length;
+		save->count++;
+	}
+	save->pin = scintilla_document_pin_text((gpointer)SSM(self, SCI_GETDOCPOINTER, 0, 0));
+
+	GTask* task = g_task_new(self, cancellable, callback, userData);
+	g_task_set_source_tag(task, gtk_scintilla_save_async);
+	g_task_set_task_data(task, save, saveFree);
+	if (save->pin)
+		g_task_run_in_thread(task, saveFileThread);
+	else
+		g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_NO_SPACE, "not enough memory to save file");
+	g_object_unref(task);
+}
+
+EXPORT gboolean gtk_scintilla_save_finish(GtkScintilla* self, GAsyncResult* result, GError** error)
+{
+	g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+
+	if (!g_task_propagate_boolean(G_TASK(result), error))
+		return FALSE;
+
+	// the file holds the snapshot, after edits during the write the document is still modified
+	GtkScintillaSave* save = g_task_get_task_data(G_TASK(result));
+	if (scintilla_document_text_unchanged((gpointer)SSM(self, SCI_GETDOCPOINTER, 0, 0), save->pin))
+		SSM(self, SCI_SETSAVEPOINT, 0, 0);
+	return TRUE;
+}
+
+// async file loading
+
+#define GSCI_LOAD_CHUNK_SIZE (1 << 20)
+
+typedef struct _GtkScintillaLoad
+{
+	GFile* file;
+	void* loader;
+	goffset size;
+	GFileProgressCallback progress;
+	gpointer progressData;
+} GtkScintillaLoad;
+
+typedef struct _GtkScintillaLoadProgress
+{
+	GTask* task;
+	goffset current;
+	goffset total;
+} GtkScintillaLoadProgress;
+
+static void loadFree(gpointer p)
+{
+	GtkScintillaLoad* load = p;
+	if (load->loader)
+		scintilla_loader_release(load->loader);
+	g_object_unref(load->file);
+	g_free(load);
+}
+
+static void loaderFree(gpointer loader)
+{
+	scintilla_loader_release(loader);
+}
+
+static gboolean loadProgressDispatch(gpointer p)
+{
+	GtkScintillaLoadProgress* prog = p;
+	GtkScintillaLoad* load = g_task_get_task_data(prog->task);
+	load->progress(prog->current, prog->total, load->progressData);
+	return G_SOURCE_REMOVE;
+}
+
+static void loadProgressFree(gpointer p)
+{
+	GtkScintillaLoadProgress* prog = p;
+	g_object_unref(prog->task);
+	g_free(prog);
+}
+
+static void loadFileThread(GTask* task, gpointer source, gpointer taskData, GCancellable* cancellable)
+{
+	GtkScintillaLoad* load = taskData;
+	GError* error = NULL;
+
+	GFileInputStream* in = g_file_read(load->file, cancellable, &error);
+	if (!in)
+	{
+		g_task_return_error(task, error);
+		return;
+	}
+
+	// the only copy: from the read buffer into the loader's gap buffer
+	char* buf = g_malloc(GSCI_LOAD_CHUNK_SIZE);
+	goffset current = 0;
+	gssize n;
+	while ((n = g_input_stream_read(G_INPUT_STREAM(in), buf, GSCI_LOAD_CHUNK_SIZE, cancellable, &error)) > 0)
+	{
+		if (scintilla_loader_add_data(load->loader, buf, n) != SC_STATUS_OK)
+		{
+			n = -1;
+			error = g_error_new_literal(G_IO_ERROR, G_IO_ERROR_NO_SPACE, "not enough memory to load file");
+			break;
+		}
+
+		current += n;
+		if (load->progress)
+		{
+			GtkScintillaLoadProgress* prog = g_new(GtkScintillaLoadProgress, 1);
+			prog->task = g_object_ref(task);
+			prog->current = current;
+			prog->total = load->size;
+			g_main_context_invoke_full(g_task_get_context(task), G_PRIORITY_DEFAULT,
+				loadProgressDispatch, prog, loadProgressFree);
+		}
+	}
+	g_free(buf);
+	g_object_unref(in);
+
+	if (n < 0)
+	{
+		g_task_return_error(task, error);
+		return;
+	}
+
+	// hand loader over to the result, finish() converts it to a document
+	void* loader = load->loader;
+	load->loader = NULL;
+	g_task_return_pointer(task, loader, loaderFree);
+}
+
+static void loadFileInfoReady(GObject* obj, GAsyncResult* res, gpointer p)
+{
+	GTask* task = p;
+	GtkScintilla* self = g_task_get_source_object(task);
+	GtkScintillaLoad* load = g_task_get_task_data(task);
+	GError* error = NULL;
+
+	GFileInfo* info = g_file_query_info_finish(G_FILE(obj), res, &error);
+	if (!info)
+	{
+		g_task_return_error(task, error);
+		g_object_unref(task);
+		return;
+	}
+	load->size = g_file_info_get_size(info);
+	g_object_unref(info);
+
+	// preallocate the whole file so the gap buffer never grows while loading
+	gintptr options = SSM(self, SCI_GETDOCUMENTOPTIONS, 0, 0);
+	if (load->size > G_MAXINT32)
+		options |= SC_DOCUMENTOPTION_TEXT_LARGE;
+	load->loader = (void*)SSM(self, SCI_CREATELOADER, load->size, options);
+	if (!load->loader)
+	{
+		g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_NO_SPACE, "not enough memory to load file");
+		g_object_unref(task);
+		return;
+	}
+
+	g_task_run_in_thread(task, loadFileThread);
+	g_object_unref(task);
+}
+
+EXPORT void gtk_scintilla_load_file_async(GtkScintilla* self, GFile* file, GCancellable* cancellable,
+	GFileProgressCallback progress, gpointer progressData, GAsyncReadyCallback callback, gpointer userData)
+{
+	GtkScintillaLoad* load = g_new0(GtkScintillaLoad, 1);
+	load->file = g_object_ref(file);
+	load->progress = progress;
+	load->progressData = progressData;
+
+	GTask* task = g_task_new(self, cancellable, callback, userData);
+	g_task_set_source_tag(task, gtk_scintilla_load_file_async);
+	g_task_set_task_data(task, load, loadFree);
+
+	g_file_query_info_async(file, G_FILE_ATTRIBUTE_STANDARD_SIZE, G_FILE_QUERY_INFO_NONE,
+		G_PRIORITY_DEFAULT, cancellable, loadFileInfoReady, task);
+}
+
+EXPORT gboolean gtk_scintilla_load_file_finish(GtkScintilla* self, GAsyncResult* result, GError** error)
+{
+	g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+
+	void* loader = g_task_propagate_pointer(G_TASK(result), error);
+	if (!loader)
+		return FALSE;
+
+	attachDocument(self, scintilla_loader_convert_to_document(loader));
+
+	// loaders are created without undo collection
+	SSM(self, SCI_SETUNDOCOLLECTION, 1, 0);
 	SSM(self, SCI_EMPTYUNDOBUFFER, 0, 0);
-	SSM(self, SCI_SETREADONLY, !priv->editable, 0);
+	SSM(self, SCI_SETSAVEPOINT, 0, 0);
+	return TRUE;
+}
+
+EXPORT gboolean gtk_scintilla_open_mapped(GtkScintilla* self, const char* path, GError** error)
+{
+	// text stays in the file mapping, the document refuses any modification
+	void* doc = scintilla_document_new_mapped(path, error);
+	if (!doc)
+		return FALSE;
+
+	attachDocument(self, doc);
+	return TRUE;
 }
 
 EXPORT void gtk_scintilla_select_range(GtkScintilla* self, gintptr start, gintptr end)
@@ -468,72 +1146,1739 @@ EXPORT void gtk_scintilla_scroll_to_pos(GtkScintilla* self, gintptr pos)
 	SSM(self, SCI_LINESCROLL, colm, line);
 }
 
-EXPORT void gtk_scintilla_reset_search(GtkScintilla* self)
+typedef struct _GtkScintillaRange
 {
-	GtkScintillaPrivate* priv = PRIVATE(self);
-	priv->searchPos = -1;
-}
+	gintptr start;
+	gintptr end;
+} GtkScintillaRange;
 
-static gintptr searchRange(GtkScintilla* sci, gintptr beg, gintptr end, const char* text, gintptr length, gboolean matchCase, gboolean wholeWord)
+static gintptr searchFlags(gboolean matchCase, gboolean wholeWord)
 {
 	gintptr flag = SCFIND_NONE;
 	if (matchCase)
 		flag |= SCFIND_MATCHCASE;
 	if (wholeWord)
 		flag |= SCFIND_WHOLEWORD;
+	return flag;
+}
 
-	SSM(sci, SCI_SETSEARCHFLAGS, flag, 0);
-	SSM(sci, SCI_SETTARGETRANGE, beg, end);
-
-	return SSM(sci, SCI_SEARCHINTARGET, length, text);
+static GtkScintillaRange visibleRange(GtkScintilla* self)
+{
+	gintptr visible = SSM(self, SCI_GETFIRSTVISIBLELINE, 0, 0);
+	gintptr first = SSM(self, SCI_DOCLINEFROMVISIBLE, visible, 0);
+	gintptr last = SSM(self, SCI_DOCLINEFROMVISIBLE, visible + SSM(self, SCI_LINESONSCREEN, 0, 0), 0);
+	GtkScintillaRange range = { SSM(self, SCI_POSITIONFROMLINE, first, 0), SSM(self, SCI_GETLINEENDPOSITION, last, 0) };
+	return range;
 }
 
-EXPORT gintptr gtk_scintilla_search_prev(GtkScintilla* self, const char* text, gintptr length, gboolean matchCase, gboolean wholeWord)
+// search sessions
+
+#define GSCI_SESSION_CHUNK_SIZE (1 << 20)
+
+struct _GtkScintillaSearch
 {
-	if (length < 0)
-		length = strlen(text);
+	GtkScintilla* self;
+	char* needle;
+	gintptr length;
+	gintptr reach;
+	gboolean matchCase;
+	gboolean wholeWord;
+	gintptr pos;
+	gintptr scanStart;
+	gintptr scanEnd;
+	GArray* matches;
+	GArray* dirty;
+	guint idle;
+};
 
-	GtkScintillaPrivate* priv = PRIVATE(self);
-	if (priv->searchPos > 0)
+static guint sessionLowerBound(GtkScintillaSearch* search, gintptr pos)
+{
+	guint low = 0;
+	guint high = search->matches->len;
+	while (low < high)
 	{
-		gintptr pos = searchRange(self, priv->searchPos - 1, 0, text, length, matchCase, wholeWord);
-		if (pos >= 0)
-		{
-			priv->searchPos = pos;
-			return pos;
-		}
+		guint mid = low + (high - low) / 2;
+		if (g_array_index(search->matches, GtkScintillaRange, mid).start < pos)
+			low = mid + 1;
+		else
+			high = mid;
 	}
+	return low;
+}
 
-	// reverse search
-	gintptr start = SSM(self, SCI_GETLENGTH, 0, 0);
-	gintptr pos = searchRange(self, start, 0, text, length, matchCase, wholeWord);
-	priv->searchPos = pos;
+static void sessionScan(GtkScintillaSearch* search, gintptr start, gintptr end)
+{
+	// every match starting in [start, end), overlapping ones too like repeated search_next, inserted in order
+	GtkScintilla* self = search->self;
+	gintptr flag = searchFlags(search->matchCase, search->wholeWord);
+	gintptr length = SSM(self, SCI_GETLENGTH, 0, 0);
+	GArray* found = g_array_new(FALSE, FALSE, sizeof(GtkScintillaRange));
+	Sci_TextToFindFull ft = { { start, MIN(end + search->reach, length) }, search->needle, { 0, 0 } };
+	while (ft.chrg.cpMin < end && SSM(self, SCI_FINDTEXTFULL, flag, &ft) >= 0 && ft.chrgText.cpMin < end)
+	{
+		GtkScintillaRange range = { ft.chrgText.cpMin, ft.chrgText.cpMax };
+		g_array_append_val(found, range);
+		ft.chrg.cpMin = ft.chrgText.cpMin + 1;
+	}
+	g_array_insert_vals(search->matches, sessionLowerBound(search, start), found->data, found->len);
+	g_array_unref(found);
+}
 
-	return pos;
+static void sessionFlush(GtkScintillaSearch* search)
+{
+	// edited lines inside the scanned part are rescanned before the matches are used
+	for (guint i = 0; i < search->dirty->len; i++)
+	{
+		GtkScintillaRange range = g_array_index(search->dirty, GtkScintillaRange, i);
+		range.start = MAX(range.start, search->scanStart);
+		range.end = MIN(range.end, search->scanEnd);
+		if (range.start >= range.end)
+			continue;
+		guint first = sessionLowerBound(search, range.start);
+		g_array_remove_range(search->matches, first, sessionLowerBound(search, range.end) - first);
+		sessionScan(search, range.start, range.end);
+	}
+	g_array_set_size(search->dirty, 0);
 }
 
-EXPORT gintptr gtk_scintilla_search_next(GtkScintilla* self, const char* text, gintptr length, gboolean matchCase, gboolean wholeWord)
+static void sessionCover(GtkScintillaSearch* search, gintptr start, gintptr end)
 {
-	if (length < 0)
-		length = strlen(text);
+	// the scanned part only ever grows as one interval
+	gintptr length = SSM(search->self, SCI_GETLENGTH, 0, 0);
+	start = CLAMP(start, 0, length);
+	end = CLAMP(end, 0, length);
+	sessionFlush(search);
+	if (start < search->scanStart)
+	{
+		sessionScan(search, start, search->scanStart);
+		search->scanStart = start;
+	}
+	if (end > search->scanEnd)
+	{
+		sessionScan(search, search->scanEnd, end);
+		search->scanEnd = end;
+	}
+}
 
-	GtkScintillaPrivate* priv = PRIVATE(self);
-	gintptr start = priv->searchPos + 1;
-	gintptr end = SSM(self, SCI_GETLENGTH, 0, 0);
-	gintptr pos = searchRange(self, start, end, text, length, matchCase, wholeWord);
-	if (pos < 0)
-		pos = searchRange(self, 0, end, text, length, matchCase, wholeWord);
+static gboolean sessionComplete(GtkScintillaSearch* search)
+{
+	return search->scanStart == 0 && search->scanEnd == SSM(search->self, SCI_GETLENGTH, 0, 0) && search->dirty->len == 0;
+}
 
-	priv->searchPos = pos;
-	return pos;
+static gboolean sessionIdle(gpointer p)
+{
+	// grows outward from where the scan started, after and then before in turn
+	GtkScintillaSearch* search = p;
+	gintptr length = SSM(search->self, SCI_GETLENGTH, 0, 0);
+	if (search->scanEnd < length)
+		sessionCover(search, search->scanStart, search->scanEnd + GSCI_SESSION_CHUNK_SIZE);
+	if (search->scanStart > 0)
+		sessionCover(search, search->scanStart - GSCI_SESSION_CHUNK_SIZE, search->scanEnd);
+	sessionFlush(search);
+
+	if (!sessionComplete(search))
+		return G_SOURCE_CONTINUE;
+	search->idle = 0;
+	return G_SOURCE_REMOVE;
 }
 
-// privates
+static void sessionSchedule(GtkScintillaSearch* search)
+{
+	if (!search->idle && !sessionComplete(search))
+		search->idle = g_idle_add(sessionIdle, search);
+}
 
-void gtk_scintilla_class_install_properties(GtkScintillaClass* klass)
+static void sessionRestart(GtkScintillaSearch* search)
 {
-	props[PROP_DARK] = g_param_spec_boolean("dark", NULL, NULL, FALSE, G_PARAM_READWRITE
-		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+	// the visible lines first, the rest of the document outward from them when idle
+	GtkScintillaRange shown = visibleRange(search->self);
+	g_array_set_size(search->matches, 0);
+	g_array_set_size(search->dirty, 0);
+	search->pos = -1;
+	search->scanStart = shown.start;
+	search->scanEnd = shown.start;
+	sessionCover(search, shown.start, shown.end);
+	sessionSchedule(search);
+}
+
+static gintptr sessionMap(gboolean insert, gintptr pos, gintptr length, gintptr p)
+{
+	if (p <= pos)
+		return p;
+	return insert ? p + length : MAX(p - length, pos);
+}
+
+static void sessionEdited(GtkScintillaSearch* search, int mod, gintptr pos, gintptr length)
+{
+	// matches after the edit are shifted, the ones in the edited lines are dropped and marked for rescan
+	gboolean insert = (mod & SC_MOD_INSERTTEXT) != 0;
+	GArray* matches = search->matches;
+	guint first = sessionLowerBound(search, pos);
+	if (!insert)
+	{
+		guint last = sessionLowerBound(search, pos + length);
+		g_array_remove_range(matches, first, last - first);
+	}
+	for (guint i = first; i < matches->len; i++)
+	{
+		GtkScintillaRange* range = &g_array_index(matches, GtkScintillaRange, i);
+		range->start += insert ? length : -length;
+		range->end += insert ? length : -length;
+	}
+
+	search->pos = search->pos < 0 ? -1 : sessionMap(insert, pos, length, search->pos);
+	search->scanStart = sessionMap(insert, pos, length, search->scanStart);
+	search->scanEnd = sessionMap(insert, pos, length, search->scanEnd);
+	for (guint i = search->dirty->len; i-- > 0;)
+	{
+		GtkScintillaRange* range = &g_array_index(search->dirty, GtkScintillaRange, i);
+		range->start = sessionMap(insert, pos, length, range->start);
+		range->end = sessionMap(insert, pos, length, range->end);
+		if (range->start >= range->end)
+			g_array_remove_index(search->dirty, i);
+	}
+
+	GtkScintilla* self = search->self;
+	gintptr firstLine = SSM(self, SCI_LINEFROMPOSITION, pos, 0);
+	gintptr lastLine = SSM(self, SCI_LINEFROMPOSITION, insert ? pos + length : pos, 0);
+	GtkScintillaRange lines = {
+		MAX(SSM(self, SCI_POSITIONFROMLINE, firstLine, 0) - search->reach, 0),
+		SSM(self, SCI_GETLINEENDPOSITION, lastLine, 0) + search->reach
+	};
+	g_array_append_val(search->dirty, lines);
+	sessionSchedule(search);
+}
+
+static gintptr sessionForward(GtkScintillaSearch* search, gintptr from)
+{
+	// index of the first match starting at or after from, -1 when there is none
+	gintptr length = SSM(search->self, SCI_GETLENGTH, 0, 0);
+	sessionCover(search, MIN(from, search->scanStart), MAX(from, search->scanEnd));
+	while (TRUE)
+	{
+		guint i = sessionLowerBound(search, from);
+		if (i < search->matches->len)
+			return i;
+		if (search->scanEnd >= length)
+			return -1;
+		sessionCover(search, search->scanStart, search->scanEnd + GSCI_SESSION_CHUNK_SIZE);
+	}
+}
+
+static gintptr sessionBackward(GtkScintillaSearch* search, gintptr before)
+{
+	// index of the last match starting before before, -1 when there is none
+	sessionCover(search, MIN(before, search->scanStart), MAX(before, search->scanEnd));
+	while (TRUE)
+	{
+		guint i = sessionLowerBound(search, before);
+		if (i > 0)
+			return i - 1;
+		if (search->scanStart == 0)
+			return -1;
+		sessionCover(search, search->scanStart - GSCI_SESSION_CHUNK_SIZE, search->scanEnd);
+	}
+}
+
+static gboolean sessionSelect(GtkScintillaSearch* search, gintptr i, GtkScintillaRange* match)
+{
+	if (i < 0)
+	{
+		search->pos = -1;
+		return FALSE;
+	}
+	GtkScintillaRange found = g_array_index(search->matches, GtkScintillaRange, i);
+	search->pos = found.start;
+	if (match)
+		*match = found;
+	return TRUE;
+}
+
+// matches of text kept up to date through edits, scanned from the visible lines outward when idle
+EXPORT GtkScintillaSearch* gtk_scintilla_search_new(GtkScintilla* self, const char* text, gintptr length, gboolean matchCase, gboolean wholeWord)
+{
+	if (length < 0)
+		length = strlen(text);
+	if (length == 0)
+		return NULL;
+
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	GtkScintillaSearch* search = g_new0(GtkScintillaSearch, 1);
+	search->self = self;
+	search->needle = g_strndup(text, length);
+	search->length = length;
+	// case folding may change the byte length of a match, a word check looks one byte further
+	search->reach = length * 4 + 1;
+	search->matchCase = !!matchCase;
+	search->wholeWord = !!wholeWord;
+	search->matches = g_array_new(FALSE, FALSE, sizeof(GtkScintillaRange));
+	search->dirty = g_array_new(FALSE, FALSE, sizeof(GtkScintillaRange));
+	g_ptr_array_add(priv->searches, search);
+	sessionRestart(search);
+	return search;
+}
+
+EXPORT void gtk_scintilla_search_free(GtkScintillaSearch* search)
+{
+	if (!search)
+		return;
+	if (search->idle)
+		g_source_remove(search->idle);
+	if (search->self)
+		g_ptr_array_remove(PRIVATE(search->self)->searches, search);
+	g_array_unref(search->matches);
+	g_array_unref(search->dirty);
+	g_free(search->needle);
+	g_free(search);
+}
+
+EXPORT gboolean gtk_scintilla_search_next_match(GtkScintillaSearch* search, GtkScintillaRange* match)
+{
+	if (!search->self)
+		return FALSE;
+
+	// wraps around to the first match
+	gintptr i = sessionForward(search, search->pos + 1);
+	if (i < 0)
+		i = sessionForward(search, 0);
+	return sessionSelect(search, i, match);
+}
+
+EXPORT gboolean gtk_scintilla_search_prev_match(GtkScintillaSearch* search, GtkScintillaRange* match)
+{
+	if (!search->self)
+		return FALSE;
+
+	// wraps around to the last match
+	gintptr i = search->pos > 0 ? sessionBackward(search, search->pos) : -1;
+	if (i < 0)
+		i = sessionBackward(search, SSM(search->self, SCI_GETLENGTH, 0, 0) + 1);
+	return sessionSelect(search, i, match);
+}
+
+EXPORT void gtk_scintilla_search_reset(GtkScintillaSearch* search)
+{
+	search->pos = -1;
+}
+
+// matches found so far, all of them once the search is complete
+EXPORT guint gtk_scintilla_search_get_count(GtkScintillaSearch* search)
+{
+	if (search->self)
+		sessionFlush(search);
+	return search->matches->len;
+}
+
+// index of the current match, -1 when there is none
+EXPORT gint gtk_scintilla_search_get_index(GtkScintillaSearch* search)
+{
+	if (!search->self || search->pos < 0)
+		return -1;
+	sessionFlush(search);
+	guint i = sessionLowerBound(search, search->pos);
+	if (i < search->matches->len && g_array_index(search->matches, GtkScintillaRange, i).start == search->pos)
+		return i;
+	return -1;
+}
+
+EXPORT gboolean gtk_scintilla_search_is_complete(GtkScintillaSearch* search)
+{
+	return search->self && sessionComplete(search);
+}
+
+static gintptr searchRange(GtkScintilla* sci, gintptr beg, gintptr end, const char* text, gintptr length, gboolean matchCase, gboolean wholeWord)
+{
+	// a single scan from beg, callers searching repeatedly for the same text keep a session instead
+	SSM(sci, SCI_SETSEARCHFLAGS, searchFlags(matchCase, wholeWord), 0);
+	SSM(sci, SCI_SETTARGETRANGE, beg, end);
+
+	return SSM(sci, SCI_SEARCHINTARGET, length, text);
+}
+
+EXPORT void gtk_scintilla_reset_search(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	priv->searchPos = -1;
+}
+
+EXPORT gintptr gtk_scintilla_search_prev(GtkScintilla* self, const char* text, gintptr length, gboolean matchCase, gboolean wholeWord)
+{
+	if (length < 0)
+		length = strlen(text);
+
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (priv->searchPos > 0)
+	{
+		gintptr pos = searchRange(self, priv->searchPos - 1, 0, text, length, matchCase, wholeWord);
+		if (pos >= 0)
+		{
+			priv->searchPos = pos;
+			return pos;
+		}
+	}
+
+	// reverse search
+	gintptr start = SSM(self, SCI_GETLENGTH, 0, 0);
+	gintptr pos = searchRange(self, start, 0, text, length, matchCase, wholeWord);
+	priv->searchPos = pos;
+
+	return pos;
+}
+
+EXPORT gintptr gtk_scintilla_search_next(GtkScintilla* self, const char* text, gintptr length, gboolean matchCase, gboolean wholeWord)
+{
+	if (length < 0)
+		length = strlen(text);
+
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	gintptr start = priv->searchPos + 1;
+	gintptr end = SSM(self, SCI_GETLENGTH, 0, 0);
+	gintptr pos = searchRange(self, start, end, text, length, matchCase, wholeWord);
+	if (pos < 0)
+		pos = searchRange(self, 0, end, text, length, matchCase, wholeWord);
+
+	priv->searchPos = pos;
+	return pos;
+}
+
+EXPORT gintptr gtk_scintilla_regex_find(GtkScintilla* self, const char* pattern, gintptr length, gboolean matchCase, gintptr start, gintptr end, gintptr* matchEnd)
+{
+	if (length < 0)
+		length = strlen(pattern);
+
+	// linear engine: no backtracking so any pattern is safe on large documents,
+	// searches backwards when start > end, -1 when not found or the pattern is invalid
+	gintptr flag = SCFIND_REGEXP | SCFIND_LINEARREGEX;
+	if (matchCase)
+		flag |= SCFIND_MATCHCASE;
+	SSM(self, SCI_SETSEARCHFLAGS, flag, 0);
+	SSM(self, SCI_SETTARGETRANGE, start, end);
+	gintptr pos = SSM(self, SCI_SEARCHINTARGET, length, pattern);
+	if (pos >= 0 && matchEnd)
+		*matchEnd = SSM(self, SCI_GETTARGETEND, 0, 0);
+
+	return pos;
+}
+
+EXPORT guint gtk_scintilla_find_all(GtkScintilla* self, const char* text, gintptr length, gboolean matchCase, gboolean wholeWord, GArray* ranges)
+{
+	if (length < 0)
+		length = strlen(text);
+	if (length == 0)
+		return 0;
+
+	// SCI_FINDTEXTFULL leaves the target alone and resumes where the last match ended
+	char* needle = g_strndup(text, length);
+	gintptr flag = searchFlags(matchCase, wholeWord);
+	Sci_TextToFindFull ft = { { 0, SSM(self, SCI_GETLENGTH, 0, 0) }, needle, { 0, 0 } };
+	guint count = 0;
+	while (ft.chrg.cpMin < ft.chrg.cpMax && SSM(self, SCI_FINDTEXTFULL, flag, &ft) >= 0)
+	{
+		GtkScintillaRange range = { ft.chrgText.cpMin, ft.chrgText.cpMax };
+		g_array_append_val(ranges, range);
+		ft.chrg.cpMin = ft.chrgText.cpMax;
+		count++;
+	}
+	g_free(needle);
+
+	return count;
+}
+
+EXPORT void gtk_scintilla_highlight_ranges(GtkScintilla* self, GArray* ranges)
+{
+	// ranges are sorted pairs of positions, replaced in the document with one redraw
+	const gintptr* data = ranges ? (const gintptr*)ranges->data : NULL;
+	gsize count = ranges ? ranges->len : 0;
+	scintilla_object_replace_indicator_ranges(SCINTILLA(self), GSCI_INDICATOR_FIND, 1, data, count);
+}
+
+// term highlighting
+
+#define GSCI_TERM_CHUNK_SIZE (256 << 10)
+
+static void termClear(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (priv->termIdle)
+	{
+		g_source_remove(priv->termIdle);
+		priv->termIdle = 0;
+	}
+	if (!priv->terms)
+		return;
+
+	// many terms usually share a few indicators, each is cleared once
+	gboolean cleared[INDICATOR_MAX + 1] = { FALSE };
+	for (guint i = 0; i < priv->termCount; i++)
+	{
+		int indicator = priv->termIndicators[i];
+		if (indicator < 0 || indicator > INDICATOR_MAX || cleared[indicator])
+			continue;
+		scintilla_object_replace_indicator_ranges(priv->sci, indicator, 0, NULL, 0);
+		cleared[indicator] = TRUE;
+	}
+	scintilla_term_matcher_free(priv->terms);
+	priv->terms = NULL;
+	g_clear_pointer(&priv->termIndicators, g_free);
+	priv->termCount = 0;
+}
+
+static gboolean termScanIdle(gpointer p)
+{
+	GtkScintilla* self = p;
+	GtkScintillaPrivate* priv = PRIVATE(self);
+
+	// a slice of whole lines per call keeps input responsive and never splits a match
+	gintptr budget = GSCI_TERM_CHUNK_SIZE;
+	while (budget > 0 && priv->termPending->len > 0)
+	{
+		GtkScintillaRange* range = &g_array_index(priv->termPending, GtkScintillaRange, 0);
+		gintptr end = range->end;
+		if (end - range->start > budget)
+			end = MIN(end, SSM(self, SCI_GETLINEENDPOSITION, SSM(self, SCI_LINEFROMPOSITION, range->start + budget, 0), 0));
+		scintilla_object_fill_terms(priv->sci, priv->terms, priv->termIndicators, range->start, end);
+		budget -= end - range->start;
+		if (end >= range->end)
+			g_array_remove_index(priv->termPending, 0);
+		else
+			range->start = end;
+	}
+
+	// edited lines are rescanned ahead of redraw, the rest of the document in idle time
+	if (priv->termPending->len > 0 && g_source_get_priority(g_main_current_source()) != G_PRIORITY_DEFAULT_IDLE)
+	{
+		priv->termIdle = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, termScanIdle, self, NULL);
+		return G_SOURCE_REMOVE;
+	}
+	if (priv->termPending->len > 0)
+		return G_SOURCE_CONTINUE;
+	priv->termIdle = 0;
+	return G_SOURCE_REMOVE;
+}
+
+static void termSchedule(GtkScintilla* self, int priority)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (priv->termIdle)
+	{
+		if (g_source_get_priority(g_main_context_find_source_by_id(NULL, priv->termIdle)) <= priority)
+			return;
+		g_source_remove(priv->termIdle);
+	}
+	priv->termIdle = g_idle_add_full(priority, termScanIdle, self, NULL);
+}
+
+static void termRestart(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (!priv->terms)
+		return;
+
+	// the visible lines are filled now, the rest of the document after them and then before them
+	gintptr length = SSM(self, SCI_GETLENGTH, 0, 0);
+	GtkScintillaRange shown = visibleRange(self);
+	scintilla_object_fill_terms(priv->sci, priv->terms, priv->termIndicators, shown.start, shown.end);
+
+	GtkScintillaRange after = { shown.end, length };
+	GtkScintillaRange before = { 0, shown.start };
+	g_array_set_size(priv->termPending, 0);
+	if (after.start < after.end)
+		g_array_append_val(priv->termPending, after);
+	if (before.start < before.end)
+		g_array_append_val(priv->termPending, before);
+	if (priv->termPending->len > 0)
+		termSchedule(self, G_PRIORITY_DEFAULT_IDLE);
+}
+
+static void termEdited(GtkScintilla* self, int mod, gintptr pos, gintptr length)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (!priv->terms)
+		return;
+
+	// indicators move with the text, only pending ranges and the edited lines need attention
+	gboolean insert = (mod & SC_MOD_INSERTTEXT) != 0;
+	for (guint i = priv->termPending->len; i-- > 0;)
+	{
+		GtkScintillaRange* range = &g_array_index(priv->termPending, GtkScintillaRange, i);
+		if (insert)
+		{
+			range->start += range->start >= pos ? length : 0;
+			range->end += range->end >= pos ? length : 0;
+		}
+		else
+		{
+			range->start = range->start <= pos ? range->start : MAX(range->start - length, pos);
+			range->end = range->end <= pos ? range->end : MAX(range->end - length, pos);
+			if (range->start >= range->end)
+				g_array_remove_index(priv->termPending, i);
+		}
+	}
+
+	gintptr first = SSM(self, SCI_LINEFROMPOSITION, pos, 0);
+	gintptr last = SSM(self, SCI_LINEFROMPOSITION, insert ? pos + length : pos, 0);
+	GtkScintillaRange lines = { SSM(self, SCI_POSITIONFROMLINE, first, 0), SSM(self, SCI_GETLINEENDPOSITION, last, 0) };
+	g_array_prepend_val(priv->termPending, lines);
+	termSchedule(self, G_PRIORITY_HIGH_IDLE);
+}
+
+// every match of terms[i] is filled with indicators[i] and value i + 1, the visible lines at once and the rest when idle
+EXPORT void gtk_scintilla_highlight_terms(GtkScintilla* self, const char* const* terms, const int* indicators, guint count, gboolean matchCase)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	termClear(self);
+	if (count == 0)
+		return;
+
+	priv->terms = scintilla_term_matcher_new(terms, count, matchCase);
+	if (!priv->terms)
+		return;
+	priv->termIndicators = g_memdup2(indicators, count * sizeof(int));
+	priv->termCount = count;
+	if (!priv->termPending)
+		priv->termPending = g_array_new(FALSE, FALSE, sizeof(GtkScintillaRange));
+	termRestart(self);
+}
+
+// search index
+
+typedef struct _GtkScintillaIndexBuild
+{
+	gpointer doc;
+	gpointer pin;
+	gpointer index;
+	const char* text[2];
+	gsize textLength[2];
+	guint pending;
+} GtkScintillaIndexBuild;
+
+typedef struct _GtkScintillaIndexSlice
+{
+	GtkScintillaIndexBuild* build;
+	guint first;
+	guint last;
+} GtkScintillaIndexSlice;
+
+static void indexSliceThread(GTask* task, gpointer source, gpointer data, GCancellable* cancellable)
+{
+	GtkScintillaIndexSlice* slice = data;
+	GtkScintillaIndexBuild* build = slice->build;
+	scintilla_trigram_index_build(build->index, build->text[0], build->textLength[0], build->text[1], build->textLength[1],
+		slice->first, slice->last);
+	g_task_return_boolean(task, TRUE);
+}
+
+// the index belongs to the document: views sharing it each ask for it, it is built with the largest
+// budget any of them asks for and only dropped once none of them wants it
+typedef struct _GtkScintillaDocIndex
+{
+	GPtrArray* views;
+	guint64 budget;
+	gboolean indexed;
+	GtkScintillaIndexBuild* build;
+} GtkScintillaDocIndex;
+
+static GHashTable* documentIndexes = NULL;
+
+static GtkScintillaDocIndex* docIndex(gpointer doc)
+{
+	if (!documentIndexes)
+		return NULL;
+	return g_hash_table_lookup(documentIndexes, doc);
+}
+
+static void indexSliceReady(GObject* obj, GAsyncResult* result, gpointer p)
+{
+	GtkScintillaIndexBuild* build = p;
+	if (--build->pending > 0)
+		return;
+
+	// a newer build, a different budget or no view wanting the index leaves this one stale
+	// while the entry is there it holds a reference so the document is still alive
+	GtkScintillaDocIndex* entry = docIndex(build->doc);
+	if (entry && entry->build == build)
+	{
+		entry->build = NULL;
+		scintilla_document_set_trigram_index(build->doc, build->index);
+	}
+	else
+		scintilla_trigram_index_free(build->index);
+
+	scintilla_text_pin_release(build->pin);
+	g_free(build);
+}
+
+static void indexBuild(GtkScintilla* self, GtkScintillaDocIndex* entry)
+{
+	gpointer doc = (gpointer)SSM(self, SCI_GETDOCPOINTER, 0, 0);
+	entry->build = NULL;
+	entry->indexed = TRUE;
+	scintilla_document_set_trigram_index(doc, NULL);
+
+	guint blocks = 0;
+	gpointer index = scintilla_trigram_index_new(doc, entry->budget, &blocks);
+	if (!index)
+		return;
+
+	// slices of blocks are built in parallel from the gap buffer halves of a pinned snapshot, edits
+	// made meanwhile are recorded by the document and replayed when the index is attached
+	GtkScintillaIndexBuild* build = g_new0(GtkScintillaIndexBuild, 1);
+	build->doc = doc;
+	build->index = index;
+	GtkScintillaChunkIter iter;
+	const char* data;
+	gsize size;
+	guint segment = 0;
+	gtk_scintilla_chunk_iter_init(self, &iter, 0, -1);
+	while (gtk_scintilla_chunk_iter_next(self, &iter, &data, &size))
+	{
+		build->text[segment] = data;
+		build->textLength[segment] = size;
+		segment++;
+	}
+	build->pin = scintilla_document_pin_text(doc);
+	if (!build->pin)
+	{
+		scintilla_document_set_trigram_index(doc, NULL);
+		scintilla_trigram_index_free(index);
+		g_free(build);
+		return;
+	}
+	entry->build = build;
+
+	guint slices = MIN(g_get_num_processors(), blocks);
+	guint perSlice = (blocks + slices - 1) / slices;
+	for (guint first = 0; first < blocks; first += perSlice)
+	{
+		GtkScintillaIndexSlice* slice = g_new(GtkScintillaIndexSlice, 1);
+		slice->build = build;
+		slice->first = first;
+		slice->last = MIN(first + perSlice, blocks);
+		build->pending++;
+
+		GTask* task = g_task_new(self, NULL, indexSliceReady, build);
+		g_task_set_task_data(task, slice, g_free);
+		g_task_run_in_thread(task, indexSliceThread);
+		g_object_unref(task);
+	}
+}
+
+static guint64 indexBudget(GtkScintillaDocIndex* entry)
+{
+	guint64 budget = 0;
+	for (guint i = 0; i < entry->views->len; i++)
+		budget = MAX(budget, PRIVATE(g_ptr_array_index(entry->views, i))->searchIndexBudget);
+	return budget;
+}
+
+// stop wanting the index of the document the view asked it for, which may not be its current one
+static void indexLeave(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	gpointer doc = priv->indexDoc;
+	GtkScintillaDocIndex* entry = docIndex(doc);
+	priv->indexDoc = NULL;
+	if (!entry)
+		return;
+
+	g_ptr_array_remove(entry->views, self);
+	if (entry->views->len > 0)
+	{
+		// another view still searches the document, only its budget may change
+		guint64 budget = indexBudget(entry);
+		if (budget != entry->budget)
+		{
+			entry->budget = budget;
+			indexBuild(g_ptr_array_index(entry->views, 0), entry);
+		}
+		return;
+	}
+
+	scintilla_document_set_trigram_index(doc, NULL);
+	g_hash_table_remove(documentIndexes, doc);
+	g_ptr_array_unref(entry->views);
+	g_free(entry);
+	SSM(self, SCI_RELEASEDOCUMENT, 0, doc);
+}
+
+static void updateSearchIndex(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	indexLeave(self);
+	if (!priv->searchIndex)
+		return;
+
+	// the entry holds a reference so the document is alive whenever a view leaves it
+	gpointer doc = (gpointer)SSM(self, SCI_GETDOCPOINTER, 0, 0);
+	GtkScintillaDocIndex* entry = docIndex(doc);
+	if (!entry)
+	{
+		if (!documentIndexes)
+			documentIndexes = g_hash_table_new(g_direct_hash, g_direct_equal);
+		entry = g_new0(GtkScintillaDocIndex, 1);
+		entry->views = g_ptr_array_new();
+		g_hash_table_insert(documentIndexes, doc, entry);
+		SSM(self, SCI_ADDREFDOCUMENT, 0, doc);
+	}
+	g_ptr_array_add(entry->views, self);
+	priv->indexDoc = doc;
+
+	guint64 budget = indexBudget(entry);
+	if (!entry->indexed || budget != entry->budget)
+	{
+		entry->budget = budget;
+		indexBuild(self, entry);
+	}
+}
+
+EXPORT gboolean gtk_scintilla_get_search_index(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	return priv->searchIndex;
+}
+
+EXPORT void gtk_scintilla_set_search_index(GtkScintilla* self, gboolean enb)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (priv->searchIndex == !!enb)
+		return;
+	priv->searchIndex = enb;
+	updateSearchIndex(self);
+	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_SEARCH_INDEX]);
+}
+
+EXPORT guint64 gtk_scintilla_get_search_index_budget(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	return priv->searchIndexBudget;
+}
+
+EXPORT void gtk_scintilla_set_search_index_budget(GtkScintilla* self, guint64 budget)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (priv->searchIndexBudget == budget)
+		return;
+	priv->searchIndexBudget = budget;
+	if (priv->searchIndex)
+		updateSearchIndex(self);
+	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_SEARCH_INDEX_BUDGET]);
+}
+
+EXPORT guint64 gtk_scintilla_get_search_index_memory(GtkScintilla* self)
+{
+	return scintilla_document_get_trigram_index_memory((gpointer)SSM(self, SCI_GETDOCPOINTER, 0, 0));
+}
+
+// async search
+
+#define GSCI_SEARCH_CHUNK_SIZE (4 << 20)
+
+typedef void (*GtkScintillaSearchFoundCallback)(GtkScintilla* self, GArray* ranges, gpointer userData);
+
+typedef struct _GtkScintillaSearchChunk
+{
+	gintptr start;
+	gintptr end;
+	GArray* ranges;
+	gint done;
+} GtkScintillaSearchChunk;
+
+typedef struct _GtkScintillaAsyncSearch
+{
+	char* needle;
+	gintptr length;
+	gboolean matchCase;
+	gboolean wholeWord;
+	gpointer pin;
+	const char* text[2];
+	gintptr textLength[2];
+	gintptr total;
+	GtkScintillaSearchChunk* chunks;
+	guint count;
+	guint next;
+	gintptr lastEnd;
+	gssize found;
+	gboolean returned;
+	GtkScintillaSearchFoundCallback foundCallback;
+	GFileProgressCallback progress;
+	gpointer progressData;
+} GtkScintillaAsyncSearch;
+
+typedef struct _GtkScintillaSearchJob
+{
+	GTask* task;
+	GtkScintillaSearchChunk* chunk;
+} GtkScintillaSearchJob;
+
+static void searchFree(gpointer p)
+{
+	GtkScintillaAsyncSearch* search = p;
+	for (guint i = 0; i < search->count; i++)
+	{
+		if (search->chunks[i].ranges)
+			g_array_unref(search->chunks[i].ranges);
+	}
+	if (search->pin)
+		scintilla_text_pin_release(search->pin);
+	g_free(search->chunks);
+	g_free(search->needle);
+	g_free(search);
+}
+
+// same classes as the default Scintilla word characters
+static int searchCharClass(guchar ch)
+{
+	if (ch == '\r' || ch == '\n')
+		return 1;
+	if (ch < 0x20 || ch == ' ')
+		return 0;
+	if (ch >= 0x80 || g_ascii_isalnum(ch) || ch == '_')
+		return 2;
+	return 3;
+}
+
+static gboolean searchIsWord(const char* window, gintptr windowStart, gintptr windowEnd, gintptr start, gintptr end)
+{
+	int first = searchCharClass(window[start - windowStart]);
+	if ((first == 2 || first == 3) && start > windowStart && searchCharClass(window[start - 1 - windowStart]) == first)
+		return FALSE;
+
+	int last = searchCharClass(window[end - 1 - windowStart]);
+	if ((last == 2 || last == 3) && end < windowEnd && searchCharClass(window[end - windowStart]) == last)
+		return FALSE;
+	return TRUE;
+}
+
+static void searchScan(const GtkScintillaAsyncSearch* search, GtkScintillaSearchChunk* chunk)
+{
+	// the window reaches one byte either side for word checks and far enough for a match starting at the end
+	gintptr windowStart = MAX(chunk->start - 1, 0);
+	gintptr windowEnd = MIN(chunk->end + search->length, search->total);
+	gintptr gap = search->textLength[0];
+
+	const char* window;
+	char* copy = NULL;
+	if (windowEnd <= gap)
+		window = search->text[0] + windowStart;
+	else if (windowStart >= gap)
+		window = search->text[1] + windowStart - gap;
+	else
+	{
+		// only the chunk across the gap is copied
+		copy = g_malloc(windowEnd - windowStart);
+		memcpy(copy, search->text[0] + windowStart, gap - windowStart);
+		memcpy(copy + gap - windowStart, search->text[1], windowEnd - gap);
+		window = copy;
+	}
+
+	guchar first = search->needle[0];
+	gboolean folded = !search->matchCase && g_ascii_isalpha(first);
+	gintptr last = MIN(chunk->end, windowEnd - search->length + 1);
+	for (gintptr pos = chunk->start; pos < last; pos++)
+	{
+		const char* p = window + (pos - windowStart);
+		if (!folded)
+		{
+			p = memchr(p, first, last - pos);
+			if (!p)
+				break;
+			pos = windowStart + (p - window);
+		}
+		else if (g_ascii_tolower(*p) != g_ascii_tolower(first))
+			continue;
+
+		gboolean match = search->matchCase
+			? memcmp(p, search->needle, search->length) == 0
+			: g_ascii_strncasecmp(p, search->needle, search->length) == 0;
+		if (match && search->wholeWord)
+			match = searchIsWord(window, windowStart, windowEnd, pos, pos + search->length);
+		if (match)
+		{
+			GtkScintillaRange range = { pos, pos + search->length };
+			g_array_append_val(chunk->ranges, range);
+		}
+	}
+
+	g_free(copy);
+}
+
+static gboolean searchDeliver(gpointer p)
+{
+	GTask* task = p;
+	GtkScintillaAsyncSearch* search = g_task_get_task_data(task);
+	if (search->returned)
+		return G_SOURCE_REMOVE;
+
+	if (g_task_return_error_if_cancelled(task))
+	{
+		search->returned = TRUE;
+		return G_SOURCE_REMOVE;
+	}
+
+	// results go out in document order, matches overlapping the previous one are dropped like a forward scan would
+	GArray* batch = g_array_new(FALSE, FALSE, sizeof(GtkScintillaRange));
+	while (search->next < search->count && g_atomic_int_get(&search->chunks[search->next].done))
+	{
+		GtkScintillaSearchChunk* chunk = &search->chunks[search->next++];
+		for (guint i = 0; i < chunk->ranges->len; i++)
+		{
+			GtkScintillaRange range = g_array_index(chunk->ranges, GtkScintillaRange, i);
+			if (range.start < search->lastEnd)
+				continue;
+			g_array_append_val(batch, range);
+			search->lastEnd = range.end;
+		}
+		g_array_unref(chunk->ranges);
+		chunk->ranges = NULL;
+	}
+
+	GtkScintilla* self = g_task_get_source_object(task);
+	search->found += batch->len;
+	if (batch->len > 0 && search->foundCallback)
+		search->foundCallback(self, batch, search->progressData);
+	g_array_unref(batch);
+
+	if (search->next > 0 && search->progress)
+		search->progress(search->chunks[search->next - 1].end, search->total, search->progressData);
+
+	if (search->next == search->count)
+	{
+		search->returned = TRUE;
+		g_task_return_int(task, search->found);
+	}
+	return G_SOURCE_REMOVE;
+}
+
+static void searchChunkThread(gpointer data, gpointer userData)
+{
+	GtkScintillaSearchJob* job = data;
+	GtkScintillaAsyncSearch* search = g_task_get_task_data(job->task);
+
+	job->chunk->ranges = g_array_new(FALSE, FALSE, sizeof(GtkScintillaRange));
+	if (!g_cancellable_is_cancelled(g_task_get_cancellable(job->task)))
+		searchScan(search, job->chunk);
+	g_atomic_int_set(&job->chunk->done, TRUE);
+
+	g_main_context_invoke_full(g_task_get_context(job->task), G_PRIORITY_DEFAULT, searchDeliver, job->task, g_object_unref);
+	g_free(job);
+}
+
+static GThreadPool* searchPool(void)
+{
+	static GThreadPool* pool = NULL;
+	if (!pool)
+		pool = g_thread_pool_new(searchChunkThread, NULL, g_get_num_processors(), FALSE, NULL);
+	return pool;
+}
+
+EXPORT void gtk_scintilla_search_async(GtkScintilla* self, const char* text, gintptr length, gboolean matchCase, gboolean wholeWord,
+	GCancellable* cancellable, GtkScintillaSearchFoundCallback found, GFileProgressCallback progress, gpointer progressData,
+	GAsyncReadyCallback callback, gpointer userData)
+{
+	if (length < 0)
+		length = strlen(text);
+
+	GtkScintillaAsyncSearch* search = g_new0(GtkScintillaAsyncSearch, 1);
+	search->needle = g_strndup(text, length);
+	search->length = length;
+	search->matchCase = matchCase;
+	search->wholeWord = wholeWord;
+	search->foundCallback = found;
+	search->progress = progress;
+	search->progressData = progressData;
+
+	// workers read the gap buffer halves directly from a pinned snapshot, edits made during the
+	// search move the document to a copy and matches are positions in the text as it was here
+	gpointer doc = (gpointer)SSM(self, SCI_GETDOCPOINTER, 0, 0);
+	GtkScintillaChunkIter iter;
+	const char* data;
+	gsize size;
+	guint segment = 0;
+	gtk_scintilla_chunk_iter_init(self, &iter, 0, -1);
+	while (gtk_scintilla_chunk_iter_next(self, &iter, &data, &size))
+	{
+		search->text[segment] = data;
+		search->textLength[segment] = size;
+		search->total += size;
+		segment++;
+	}
+	search->pin = scintilla_document_pin_text(doc);
+
+	// with a search index only the runs of blocks where a match may start are scanned
+	GArray* runs = g_array_new(FALSE, FALSE, sizeof(GtkScintillaRange));
+	if (length > 0 && search->total >= length
+		&& !scintilla_document_trigram_candidates(doc, search->needle, length, matchCase, runs))
+	{
+		GtkScintillaRange all = { 0, search->total };
+		g_array_append_val(runs, all);
+	}
+	for (guint i = 0; i < runs->len; i++)
+	{
+		GtkScintillaRange run = g_array_index(runs, GtkScintillaRange, i);
+		search->count += (run.end - run.start + GSCI_SEARCH_CHUNK_SIZE - 1) / GSCI_SEARCH_CHUNK_SIZE;
+	}
+	search->chunks = g_new0(GtkScintillaSearchChunk, search->count);
+	guint count = 0;
+	for (guint i = 0; i < runs->len; i++)
+	{
+		GtkScintillaRange run = g_array_index(runs, GtkScintillaRange, i);
+		for (gintptr start = run.start; start < run.end; start += GSCI_SEARCH_CHUNK_SIZE)
+		{
+			search->chunks[count].start = start;
+			search->chunks[count].end = MIN(start + GSCI_SEARCH_CHUNK_SIZE, run.end);
+			count++;
+		}
+	}
+	g_array_unref(runs);
+
+	GTask* task = g_task_new(self, cancellable, callback, userData);
+	g_task_set_source_tag(task, gtk_scintilla_search_async);
+	g_task_set_task_data(task, search, searchFree);
+
+	if (!search->pin)
+	{
+		search->count = 0;
+		search->returned = TRUE;
+		g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_NO_SPACE, "not enough memory to search");
+	}
+	else if (search->count == 0)
+	{
+		search->returned = TRUE;
+		g_task_return_int(task, 0);
+	}
+
+	for (guint i = 0; i < search->count; i++)
+	{
+		GtkScintillaSearchJob* job = g_new(GtkScintillaSearchJob, 1);
+		job->task = g_object_ref(task);
+		job->chunk = &search->chunks[i];
+		g_thread_pool_push(searchPool(), job, NULL);
+	}
+	g_object_unref(task);
+}
+
+EXPORT gssize gtk_scintilla_search_finish(GtkScintilla* self, GAsyncResult* result, GError** error)
+{
+	g_return_val_if_fail(g_task_is_valid(result, self), -1);
+	return g_task_propagate_int(G_TASK(result), error);
+}
+
+// log streaming
+
+static void logTrim(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	gintptr length = SSM(self, SCI_GETLENGTH, 0, 0);
+	gintptr lines = SSM(self, SCI_GETLINECOUNT, 0, 0);
+	if (length > 0 && SSM(self, SCI_GETCHARAT, length - 1, 0) == '\n')
+		lines--; // the empty line after the last newline
+	if (priv->logMaxLines == 0 || lines <= priv->logMaxLines)
+		return;
+
+	// a single deletion so selection, markers, indicators and searches shift once
+	gintptr end = SSM(self, SCI_POSITIONFROMLINE, lines - priv->logMaxLines, 0);
+	SSM(self, SCI_DELETERANGE, 0, end);
+}
+
+static gintptr logDisplayLines(GtkScintilla* self)
+{
+	gintptr last = SSM(self, SCI_GETLINECOUNT, 0, 0) - 1;
+	return SSM(self, SCI_VISIBLEFROMDOCLINE, last, 0) + SSM(self, SCI_WRAPCOUNT, last, 0);
+}
+
+static void logApply(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (!priv->logPending || priv->logPending->len == 0)
+		return;
+	// follow the tail only when the last line is already shown
+	gintptr onScreen = SSM(self, SCI_LINESONSCREEN, 0, 0);
+	gboolean follow = SSM(self, SCI_GETFIRSTVISIBLELINE, 0, 0) + onScreen >= logDisplayLines(self);
+
+	setReadOnly(priv, FALSE);
+	SSM(self, SCI_APPENDTEXT, priv->logPending->len, priv->logPending->str);
+	logTrim(self);
+	setReadOnly(priv, !priv->docState->editable);
+	g_string_truncate(priv->logPending, 0);
+	ringSetPending(priv->appendRing, 0);
+
+	if (follow)
+		SSM(self, SCI_SETFIRSTVISIBLELINE, MAX(logDisplayLines(self) - onScreen, 0), 0);
+}
+
+static gboolean logFlush(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	priv->logTick = 0;
+	priv->logTimer = 0;
+	logApply(self);
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean logTickCallback(GtkWidget* widget, GdkFrameClock* clock, gpointer data)
+{
+	return logFlush(GTK_SCINTILLA(widget));
+}
+
+static gboolean logTimeout(gpointer p)
+{
+	return logFlush(p);
+}
+
+void logSchedule(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (priv->logTick || priv->logTimer)
+		return;
+
+	// once per frame, hidden widgets do not tick so they use a timer instead
+	if (gtk_widget_get_mapped(GTK_WIDGET(self)))
+		priv->logTick = gtk_widget_add_tick_callback(GTK_WIDGET(self), logTickCallback, NULL, NULL);
+	else
+		priv->logTimer = g_timeout_add(GSCI_LOG_INTERVAL, logTimeout, self);
+}
+
+static void logCancel(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (priv->logTick)
+	{
+		gtk_widget_remove_tick_callback(GTK_WIDGET(self), priv->logTick);
+		priv->logTick = 0;
+	}
+	if (priv->logTimer)
+	{
+		g_source_remove(priv->logTimer);
+		priv->logTimer = 0;
+	}
+}
+
+void logDrop(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	logCancel(self);
+	if (priv->logPending)
+		g_string_truncate(priv->logPending, 0);
+	ringSetPending(priv->appendRing, 0);
+}
+
+void logConfigHistory(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (priv->logMode)
+	{
+		SSM(self, SCI_SETCHANGEHISTORY, SC_CHANGE_HISTORY_DISABLED, 0);
+		SSM(self, SCI_SETUNDOCOLLECTION, FALSE, 0);
+		gtk_scintilla_clear_undo_redo(self);
+	}
+	else
+	{
+		SSM(self, SCI_SETUNDOCOLLECTION, TRUE, 0);
+	}
+}
+
+void onUnmap(GtkScintilla* self, gpointer data)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (priv->logTick)
+	{
+		gtk_widget_remove_tick_callback(GTK_WIDGET(self), priv->logTick);
+		priv->logTick = 0;
+		logSchedule(self);
+	}
+	if (priv->changesTick)
+	{
+		gtk_widget_remove_tick_callback(GTK_WIDGET(self), priv->changesTick);
+		priv->changesTick = 0;
+		changesSchedule(self);
+	}
+}
+
+EXPORT gboolean gtk_scintilla_get_log_mode(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	return priv->logMode;
+}
+
+// appended text is batched per frame without undo or change history, see also log-max-lines
+EXPORT void gtk_scintilla_set_log_mode(GtkScintilla* self, gboolean enb)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (!priv->logMode == !enb)
+		return;
+
+	if (!enb)
+	{
+		logCancel(self);
+		logApply(self);
+	}
+	else
+		priv->logChangeHistory = SSM(self, SCI_GETCHANGEHISTORY, 0, 0);
+	priv->logMode = enb;
+	logConfigHistory(self);
+	// restored once undo collection is back on, the undo buffer is still empty from log mode
+	if (!enb)
+		SSM(self, SCI_SETCHANGEHISTORY, priv->logChangeHistory, 0);
+	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_LOG_MODE]);
+}
+
+EXPORT guint gtk_scintilla_get_log_max_lines(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	return priv->logMaxLines;
+}
+
+// lines kept in log mode, the oldest are removed from the top, 0 keeps everything
+EXPORT void gtk_scintilla_set_log_max_lines(GtkScintilla* self, guint lines)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	priv->logMaxLines = lines;
+	if (priv->logMode)
+	{
+		setReadOnly(priv, FALSE);
+		logTrim(self);
+		setReadOnly(priv, !priv->docState->editable);
+	}
+	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_LOG_MAX_LINES]);
+}
+
+// thread-safe appends
+
+// bytes written by producer threads, drained in one batch by the main loop. Producers share one
+// lock rather than a lock-free queue: over the budget they sleep on a condition until the main
+// loop makes room, and under it a push only holds the lock for a memcpy.
+struct _GtkScintillaAppendRing
+{
+	gatomicrefcount ref;
+	GMutex lock;
+	GCond space;
+	char* data;
+	gsize size;
+	gsize head;
+	gsize length;
+	gsize pending; // log mode text drained but not yet appended, counted toward the budget
+	guint64 budget;
+	GtkScintilla* self;
+	gboolean scheduled;
+	GString* drain;
+};
+
+GtkScintillaAppendRing* ringNew(GtkScintilla* self)
+{
+	GtkScintillaAppendRing* ring = g_new0(GtkScintillaAppendRing, 1);
+	g_atomic_ref_count_init(&ring->ref);
+	g_mutex_init(&ring->lock);
+	g_cond_init(&ring->space);
+	ring->budget = GSCI_APPEND_BUDGET;
+	ring->self = self;
+	ring->drain = g_string_new(NULL);
+	return ring;
+}
+
+static GtkScintillaAppendRing* ringRef(GtkScintillaAppendRing* ring)
+{
+	g_atomic_ref_count_inc(&ring->ref);
+	return ring;
+}
+
+void ringUnref(gpointer p)
+{
+	GtkScintillaAppendRing* ring = p;
+	if (!g_atomic_ref_count_dec(&ring->ref))
+		return;
+	g_mutex_clear(&ring->lock);
+	g_cond_clear(&ring->space);
+	g_string_free(ring->drain, TRUE);
+	g_free(ring->data);
+	g_free(ring);
+}
+
+// called on the main thread, producers waiting for space return FALSE
+void ringClose(GtkScintillaAppendRing* ring)
+{
+	g_mutex_lock(&ring->lock);
+	ring->self = NULL;
+	ring->length = 0;
+	ring->pending = 0;
+	g_cond_broadcast(&ring->space);
+	g_mutex_unlock(&ring->lock);
+}
+
+// called on the main thread whenever the log mode queue changes length
+void ringSetPending(GtkScintillaAppendRing* ring, gsize pending)
+{
+	g_mutex_lock(&ring->lock);
+	if (pending < ring->pending)
+		g_cond_broadcast(&ring->space);
+	ring->pending = pending;
+	g_mutex_unlock(&ring->lock);
+}
+
+// with the lock held, make room for length more bytes keeping the queued ones in order
+static void ringReserve(GtkScintillaAppendRing* ring, gsize length)
+{
+	if (ring->length + length <= ring->size)
+		return;
+
+	gsize size = MAX(MAX(ring->size * 2, ring->length + length), 4096);
+	char* data = g_malloc(size);
+	gsize first = MIN(ring->length, ring->size - ring->head);
+	if (ring->length)
+	{
+		memcpy(data, ring->data + ring->head, first);
+		memcpy(data + first, ring->data, ring->length - first);
+	}
+	g_free(ring->data);
+	ring->data = data;
+	ring->size = size;
+	ring->head = 0;
+}
+
+static gboolean ringDrain(gpointer p)
+{
+	GtkScintillaAppendRing* ring = p;
+	g_string_truncate(ring->drain, 0);
+
+	// copy out so producers only wait for a memcpy and not for the insertion
+	g_mutex_lock(&ring->lock);
+	ring->scheduled = FALSE;
+	GtkScintilla* self = ring->self;
+	gsize first = MIN(ring->length, ring->size - ring->head);
+	g_string_append_len(ring->drain, ring->data + ring->head, first);
+	g_string_append_len(ring->drain, ring->data, ring->length - first);
+	ring->head = ring->size ? (ring->head + ring->length) % ring->size : 0;
+	// in log mode the bytes only move to the pending queue, producers keep waiting for them
+	if (self && PRIVATE(self)->logMode)
+		ring->pending += ring->length;
+	ring->length = 0;
+	g_cond_broadcast(&ring->space);
+	g_mutex_unlock(&ring->lock);
+
+	if (self && ring->drain->len)
+		gtk_scintilla_append_text(self, ring->drain->str, ring->drain->len);
+	return G_SOURCE_REMOVE;
+}
+
+// may be called from any thread holding a reference to the widget, the text is appended
+// by the main loop together with everything else queued since it last ran.
+// Blocks while more than the append budget is queued, FALSE once the widget is disposed.
+// The main thread never blocks, only the main loop can make room.
+EXPORT gboolean gtk_scintilla_append_text_threadsafe(GtkScintilla* self, const char* text, gssize length)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	GtkScintillaAppendRing* ring = priv->appendRing;
+	gsize n = length < 0 ? strlen(text) : (gsize)length;
+	gboolean wait = !g_main_context_is_owner(g_main_context_default());
+
+	g_mutex_lock(&ring->lock);
+	// a single append over the budget still goes through once nothing is queued
+	while (wait && ring->self && ring->length + ring->pending > 0 && ring->budget > 0
+		&& ring->length + ring->pending + n > ring->budget)
+		g_cond_wait(&ring->space, &ring->lock);
+	if (!ring->self || n == 0)
+	{
+		gboolean open = ring->self != NULL;
+		g_mutex_unlock(&ring->lock);
+		return open;
+	}
+
+	ringReserve(ring, n);
+	gsize tail = (ring->head + ring->length) % ring->size;
+	gsize first = MIN(n, ring->size - tail);
+	memcpy(ring->data + tail, text, first);
+	memcpy(ring->data, text + first, n - first);
+	ring->length += n;
+
+	// one wakeup for the whole batch
+	gboolean schedule = !ring->scheduled;
+	ring->scheduled = TRUE;
+	g_mutex_unlock(&ring->lock);
+
+	if (schedule)
+		g_idle_add_full(G_PRIORITY_DEFAULT, ringDrain, ringRef(ring), ringUnref);
+	return TRUE;
+}
+
+EXPORT guint64 gtk_scintilla_get_append_budget(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	g_mutex_lock(&priv->appendRing->lock);
+	guint64 budget = priv->appendRing->budget;
+	g_mutex_unlock(&priv->appendRing->lock);
+	return budget;
+}
+
+// bytes gtk_scintilla_append_text_threadsafe may queue before producers wait, 0 never waits
+EXPORT void gtk_scintilla_set_append_budget(GtkScintilla* self, guint64 budget)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	g_mutex_lock(&priv->appendRing->lock);
+	priv->appendRing->budget = budget;
+	g_cond_broadcast(&priv->appendRing->space);
+	g_mutex_unlock(&priv->appendRing->lock);
+	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_APPEND_BUDGET]);
+}
+
+// performance tuning
+
+static void untune(GtkScintilla* self)
+{
+	// an explicit setting ends the auto profile
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (priv->tuned)
+	{
+		priv->tuned = false;
+		g_object_notify_by_pspec(G_OBJECT(self), props[PROP_PERFORMANCE_PROFILE]);
+	}
+}
+
+static void tuneSet(GtkScintilla* self, int getMessage, int setMessage, sptr_t value, GParamSpec* prop)
+{
+	// unchanged levels are not sent again, changing a cache drops what it holds
+	if (SSM(self, getMessage, 0, 0) != value)
+	{
+		SSM(self, setMessage, value, 0);
+		g_object_notify_by_pspec(G_OBJECT(self), prop);
+	}
+}
+
+// measured durations are noisy, a level only changes once the estimate is well past the threshold
+static gboolean tuneAbove(double seconds, double threshold, gboolean above)
+{
+	return above ? seconds > threshold / GSCI_TUNE_HYSTERESIS : seconds > threshold * GSCI_TUNE_HYSTERESIS;
+}
+
+void tune(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (!priv->tuned)
+		return;
+
+	// seconds per byte measured by the core while styling and wrapping
+	double styleOneByte, wrapOneByte;
+	scintilla_object_get_action_durations(priv->sci, &styleOneByte, &wrapOneByte);
+	gintptr length = SSM(self, SCI_GETLENGTH, 0, 0);
+	gintptr lines = SSM(self, SCI_GETLINECOUNT, 0, 0);
+	priv->tuneBucket = g_bit_storage(length);
+	gboolean wrap = priv->wrapMode != GTK_WRAP_NONE;
+	gboolean large = length >= GSCI_TUNE_LARGE_DOCUMENT;
+
+	// threads pay off when many or long lines are laid out, the core caps them at the hardware concurrency
+	guint threads = wrap || large ? g_get_num_processors() : 1;
+	tuneSet(self, SCI_GETLAYOUTTHREADS, SCI_SETLAYOUTTHREADS, threads, props[PROP_LAYOUT_THREADS]);
+
+	// styling everything in idle time is only worth it while the whole document styles quickly
+	gboolean slowStyle = tuneAbove(styleOneByte * length, GSCI_TUNE_STYLE_SECONDS,
+		SSM(self, SCI_GETIDLESTYLING, 0, 0) == SC_IDLESTYLING_AFTERVISIBLE);
+	int idle = slowStyle ? SC_IDLESTYLING_AFTERVISIBLE : SC_IDLESTYLING_ALL;
+	tuneSet(self, SCI_GETIDLESTYLING, SCI_SETIDLESTYLING, idle, props[PROP_IDLE_STYLING]);
+
+	// keep every wrapped layout when wrapping the document again is noticeable and it still fits in memory
+	gboolean slowWrap = tuneAbove(wrapOneByte * length, GSCI_TUNE_WRAP_SECONDS,
+		SSM(self, SCI_GETLAYOUTCACHE, 0, 0) == SC_CACHE_DOCUMENT);
+	int cache = wrap && slowWrap && lines <= GSCI_TUNE_DOCUMENT_CACHE_LINES ? SC_CACHE_DOCUMENT : SC_CACHE_PAGE;
+	tuneSet(self, SCI_GETLAYOUTCACHE, SCI_SETLAYOUTCACHE, cache, props[PROP_LAYOUT_CACHE]);
+
+	guint positions = large || wrap ? GSCI_POSITION_CACHE_LARGE : GSCI_POSITION_CACHE;
+	tuneSet(self, SCI_GETPOSITIONCACHE, SCI_SETPOSITIONCACHE, positions, props[PROP_POSITION_CACHE]);
+}
+
+EXPORT guint gtk_scintilla_get_layout_threads(GtkScintilla* self)
+{
+	return (guint)SSM(self, SCI_GETLAYOUTTHREADS, 0, 0);
+}
+
+// threads laying out long lines, capped at the hardware concurrency
+EXPORT void gtk_scintilla_set_layout_threads(GtkScintilla* self, guint threads)
+{
+	untune(self);
+	SSM(self, SCI_SETLAYOUTTHREADS, threads, 0);
+	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_LAYOUT_THREADS]);
+}
+
+EXPORT guint gtk_scintilla_get_idle_styling(GtkScintilla* self)
+{
+	return (guint)SSM(self, SCI_GETIDLESTYLING, 0, 0);
+}
+
+// one of SC_IDLESTYLING_NONE, TOVISIBLE, AFTERVISIBLE or ALL
+EXPORT void gtk_scintilla_set_idle_styling(GtkScintilla* self, guint idle)
+{
+	untune(self);
+	SSM(self, SCI_SETIDLESTYLING, idle, 0);
+	restyleStart(self);
+	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_IDLE_STYLING]);
+}
+
+EXPORT guint gtk_scintilla_get_layout_cache(GtkScintilla* self)
+{
+	return (guint)SSM(self, SCI_GETLAYOUTCACHE, 0, 0);
+}
+
+// one of SC_CACHE_NONE, CARET, PAGE or DOCUMENT
+EXPORT void gtk_scintilla_set_layout_cache(GtkScintilla* self, guint cache)
+{
+	untune(self);
+	SSM(self, SCI_SETLAYOUTCACHE, cache, 0);
+	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_LAYOUT_CACHE]);
+}
+
+EXPORT guint gtk_scintilla_get_position_cache(GtkScintilla* self)
+{
+	return (guint)SSM(self, SCI_GETPOSITIONCACHE, 0, 0);
+}
+
+// entries of measured text segments kept, 0 measures every segment
+EXPORT void gtk_scintilla_set_position_cache(GtkScintilla* self, guint size)
+{
+	untune(self);
+	SSM(self, SCI_SETPOSITIONCACHE, size, 0);
+	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_POSITION_CACHE]);
+}
+
+EXPORT const char* gtk_scintilla_get_performance_profile(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	return priv->tuned ? "auto" : "default";
+}
+
+// "auto" picks threads, idle styling and cache sizes from the document size, wrapping and measured
+// styling and wrapping times and keeps them up to date, "default" leaves the current values alone
+EXPORT void gtk_scintilla_set_performance_profile(GtkScintilla* self, const char* profile)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	gboolean tuned = g_strcmp0(profile, "auto") == 0;
+	if (!priv->tuned == !tuned)
+		return;
+
+	priv->tuned = tuned;
+	tune(self);
+	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_PERFORMANCE_PROFILE]);
+}
+
+// text area drawing since the last reset, times in microseconds, scrolled frames only painted the lines
+// scrolled into view and reused the rest, recorded lines counts the display lines painted again
+typedef struct _GtkScintillaFrameStats
+{
+	guint64 frames;
+	guint64 scrolledFrames;
+	gint64 totalTime;
+	gint64 maxTime;
+	guint64 recordedLines;
+} GtkScintillaFrameStats;
+
+// shaped text kept for drawing by all widgets since the last reset, size and budget in approximate bytes
+typedef struct _GtkScintillaGlyphCacheStats
+{
+	guint64 hits;
+	guint64 misses;
+	guint64 entries;
+	guint64 size;
+	guint64 budget;
+} GtkScintillaGlyphCacheStats;
+
+EXPORT void gtk_scintilla_get_frame_stats(GtkScintilla* self, GtkScintillaFrameStats* stats)
+{
+	ScintillaFrameStats frame;
+	scintilla_object_get_frame_stats(SCINTILLA(self), &frame);
+	stats->frames = frame.frames;
+	stats->scrolledFrames = frame.scrolledFrames;
+	stats->recordedLines = frame.recordedLines;
+	stats->totalTime = frame.totalTime;
+	stats->maxTime = frame.maxTime;
+}
+
+EXPORT void gtk_scintilla_reset_frame_stats(GtkScintilla* self)
+{
+	scintilla_object_reset_frame_stats(SCINTILLA(self));
+}
+
+EXPORT void gtk_scintilla_get_glyph_cache_stats(GtkScintillaGlyphCacheStats* stats)
+{
+	ScintillaGlyphCacheStats cache;
+	scintilla_glyph_cache_get_stats(&cache);
+	stats->hits = cache.hits;
+	stats->misses = cache.misses;
+	stats->entries = cache.entries;
+	stats->size = cache.size;
+	stats->budget = cache.budget;
+}
+
+EXPORT void gtk_scintilla_reset_glyph_cache_stats(void)
+{
+	scintilla_glyph_cache_reset_stats();
+}
+
+EXPORT void gtk_scintilla_set_glyph_cache_budget(guint64 budget)
+{
+	scintilla_glyph_cache_set_budget((gsize)MIN(budget, G_MAXSIZE));
+}
+
+EXPORT void gtk_scintilla_set_measuring_pool_size(guint size)
+{
+	scintilla_measuring_pool_set_size(size);
+}
+
+// privates
+
+void gtk_scintilla_dispose(GObject* obj)
+{
+	GtkScintillaPrivate* priv = PRIVATE(GTK_SCINTILLA(obj));
+	if (priv->restyleTimer)
+	{
+		g_source_remove(priv->restyleTimer);
+		priv->restyleTimer = 0;
+	}
+	if (priv->termIdle)
+	{
+		g_source_remove(priv->termIdle);
+		priv->termIdle = 0;
+	}
+	g_clear_pointer(&priv->terms, scintilla_term_matcher_free);
+	g_clear_pointer(&priv->termIndicators, g_free);
+	g_clear_pointer(&priv->termPending, g_array_unref);
+	changesDrop(GTK_SCINTILLA(obj));
+	logCancel(GTK_SCINTILLA(obj));
+	indexLeave(GTK_SCINTILLA(obj));
+	docStateLeave(GTK_SCINTILLA(obj));
+	if (priv->logPending)
+	{
+		g_string_free(priv->logPending, TRUE);
+		priv->logPending = NULL;
+	}
+
+	// sessions the application still holds stop following the widget
+	if (priv->searches)
+	{
+		for (guint i = 0; i < priv->searches->len; i++)
+		{
+			GtkScintillaSearch* search = g_ptr_array_index(priv->searches, i);
+			if (search->idle)
+				g_source_remove(search->idle);
+			search->idle = 0;
+			search->self = NULL;
+		}
+	}
+	g_clear_pointer(&priv->searches, g_ptr_array_unref);
+
+	// producers may still hold a reference so the ring itself lives until finalize
+	ringClose(priv->appendRing);
+
+	G_OBJECT_CLASS(gtk_scintilla_parent_class)->dispose(obj);
+}
+
+void gtk_scintilla_finalize(GObject* obj)
+{
+	GtkScintillaPrivate* priv = PRIVATE(GTK_SCINTILLA(obj));
+	ringUnref(priv->appendRing);
+
+	G_OBJECT_CLASS(gtk_scintilla_parent_class)->finalize(obj);
+}
+
+void gtk_scintilla_class_install_properties(GtkScintillaClass* klass)
+{
+	props[PROP_DARK] = g_param_spec_boolean("dark", NULL, NULL, FALSE, G_PARAM_READWRITE
+		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
 
 	props[PROP_STYLE] = g_param_spec_string("style", NULL, NULL, "default", G_PARAM_READWRITE
 		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
@@ -565,6 +2910,45 @@ void gtk_scintilla_class_install_properties(GtkScintillaClass* klass)
 	props[PROP_WRAP_MODE] = g_param_spec_enum("wrap-mode", NULL, NULL, GTK_TYPE_WRAP_MODE, GTK_WRAP_NONE, G_PARAM_READWRITE
 		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
 
+	props[PROP_SEARCH_INDEX] = g_param_spec_boolean("search-index", NULL, NULL, FALSE, G_PARAM_READWRITE
+		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+	props[PROP_SEARCH_INDEX_BUDGET] = g_param_spec_uint64("search-index-budget", NULL, NULL, 0, G_MAXUINT64, 0, G_PARAM_READWRITE
+		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+	props[PROP_RESTYLE_PROGRESS] = g_param_spec_double("restyle-progress", NULL, NULL, 0.0, 1.0, 1.0, G_PARAM_READABLE
+		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+	props[PROP_MOD_EVENT_MASK] = g_param_spec_uint("mod-event-mask", NULL, NULL, 0, SC_MODEVENTMASKALL, SC_MODEVENTMASKALL, G_PARAM_READWRITE
+		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+	props[PROP_LINE_NUMBER_MAX_LINES] = g_param_spec_uint("line-number-max-lines", NULL, NULL, 0, G_MAXUINT, 0, G_PARAM_READWRITE
+		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+	props[PROP_LOG_MODE] = g_param_spec_boolean("log-mode", NULL, NULL, FALSE, G_PARAM_READWRITE
+		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+	props[PROP_LOG_MAX_LINES] = g_param_spec_uint("log-max-lines", NULL, NULL, 0, G_MAXUINT, 0, G_PARAM_READWRITE
+		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+	props[PROP_APPEND_BUDGET] = g_param_spec_uint64("append-budget", NULL, NULL, 0, G_MAXUINT64, GSCI_APPEND_BUDGET, G_PARAM_READWRITE
+		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+	props[PROP_LAYOUT_THREADS] = g_param_spec_uint("layout-threads", NULL, NULL, 1, G_MAXUINT, 1, G_PARAM_READWRITE
+		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+	props[PROP_IDLE_STYLING] = g_param_spec_uint("idle-styling", NULL, NULL, SC_IDLESTYLING_NONE, SC_IDLESTYLING_ALL, SC_IDLESTYLING_ALL, G_PARAM_READWRITE
+		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+	props[PROP_LAYOUT_CACHE] = g_param_spec_uint("layout-cache", NULL, NULL, SC_CACHE_NONE, SC_CACHE_DOCUMENT, SC_CACHE_CARET, G_PARAM_READWRITE
+		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+	props[PROP_POSITION_CACHE] = g_param_spec_uint("position-cache", NULL, NULL, 0, G_MAXUINT16, GSCI_POSITION_CACHE, G_PARAM_READWRITE
+		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+	props[PROP_PERFORMANCE_PROFILE] = g_param_spec_string("performance-profile", NULL, NULL, "default", G_PARAM_READWRITE
+		| G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
 	g_object_class_install_properties(G_OBJECT_CLASS(klass), PROP_COUNT, props);
 }
 
@@ -617,6 +3001,58 @@ void gtk_scintilla_get_property(GObject* obj, guint prop, GValue* val, GParamSpe
 		g_value_set_enum(val, gtk_scintilla_get_wrap_mode(self));
 		break;
 
+	case PROP_SEARCH_INDEX:
+		g_value_set_boolean(val, gtk_scintilla_get_search_index(self));
+		break;
+
+	case PROP_SEARCH_INDEX_BUDGET:
+		g_value_set_uint64(val, gtk_scintilla_get_search_index_budget(self));
+		break;
+
+	case PROP_RESTYLE_PROGRESS:
+		g_value_set_double(val, gtk_scintilla_get_restyle_progress(self));
+		break;
+
+	case PROP_MOD_EVENT_MASK:
+		g_value_set_uint(val, gtk_scintilla_get_mod_event_mask(self));
+		break;
+
+	case PROP_LOG_MODE:
+		g_value_set_boolean(val, gtk_scintilla_get_log_mode(self));
+		break;
+
+	case PROP_LINE_NUMBER_MAX_LINES:
+		g_value_set_uint(val, gtk_scintilla_get_line_number_max_lines(self));
+		break;
+
+	case PROP_LOG_MAX_LINES:
+		g_value_set_uint(val, gtk_scintilla_get_log_max_lines(self));
+		break;
+
+	case PROP_APPEND_BUDGET:
+		g_value_set_uint64(val, gtk_scintilla_get_append_budget(self));
+		break;
+
+	case PROP_LAYOUT_THREADS:
+		g_value_set_uint(val, gtk_scintilla_get_layout_threads(self));
+		break;
+
+	case PROP_IDLE_STYLING:
+		g_value_set_uint(val, gtk_scintilla_get_idle_styling(self));
+		break;
+
+	case PROP_LAYOUT_CACHE:
+		g_value_set_uint(val, gtk_scintilla_get_layout_cache(self));
+		break;
+
+	case PROP_POSITION_CACHE:
+		g_value_set_uint(val, gtk_scintilla_get_position_cache(self));
+		break;
+
+	case PROP_PERFORMANCE_PROFILE:
+		g_value_set_string(val, gtk_scintilla_get_performance_profile(self));
+		break;
+
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(obj, prop, ps);
 		break;
@@ -664,10 +3100,58 @@ void gtk_scintilla_set_property(GObject* obj, guint prop, const GValue* val, GPa
 		gtk_scintilla_set_wrap_mode(self, g_value_get_enum(val));
 		break;
 
+	case PROP_SEARCH_INDEX:
+		gtk_scintilla_set_search_index(self, g_value_get_boolean(val));
+		break;
+
+	case PROP_SEARCH_INDEX_BUDGET:
+		gtk_scintilla_set_search_index_budget(self, g_value_get_uint64(val));
+		break;
+
 	case PROP_AUTO_INDENT:
 		gtk_scintilla_set_auto_indent(self, g_value_get_boolean(val));
 		break;
 
+	case PROP_MOD_EVENT_MASK:
+		gtk_scintilla_set_mod_event_mask(self, g_value_get_uint(val));
+		break;
+
+	case PROP_LOG_MODE:
+		gtk_scintilla_set_log_mode(self, g_value_get_boolean(val));
+		break;
+
+	case PROP_LINE_NUMBER_MAX_LINES:
+		gtk_scintilla_set_line_number_max_lines(self, g_value_get_uint(val));
+		break;
+
+	case PROP_LOG_MAX_LINES:
+		gtk_scintilla_set_log_max_lines(self, g_value_get_uint(val));
+		break;
+
+	case PROP_APPEND_BUDGET:
+		gtk_scintilla_set_append_budget(self, g_value_get_uint64(val));
+		break;
+
+	case PROP_LAYOUT_THREADS:
+		gtk_scintilla_set_layout_threads(self, g_value_get_uint(val));
+		break;
+
+	case PROP_IDLE_STYLING:
+		gtk_scintilla_set_idle_styling(self, g_value_get_uint(val));
+		break;
+
+	case PROP_LAYOUT_CACHE:
+		gtk_scintilla_set_layout_cache(self, g_value_get_uint(val));
+		break;
+
+	case PROP_POSITION_CACHE:
+		gtk_scintilla_set_position_cache(self, g_value_get_uint(val));
+		break;
+
+	case PROP_PERFORMANCE_PROFILE:
+		gtk_scintilla_set_performance_profile(self, g_value_get_string(val));
+		break;
+
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(obj, prop, ps);
 		break;
@@ -685,111 +3169,213 @@ void gtk_scintilla_class_install_signals(GtkScintillaClass* klass)
 		g_cclosure_marshal_VOID__VOID,
 		G_TYPE_NONE, 0
 	);
+
+	// coalesced GtkScintillaChange spans and the range of lines they touch, at most once per frame
+	signals[SIGNAL_CHANGES] = g_signal_new(
+		"changes",
+		G_TYPE_FROM_CLASS(klass),
+		G_SIGNAL_RUN_LAST,
+		G_STRUCT_OFFSET(GtkScintillaClass, changes),
+		NULL, NULL,
+		NULL,
+		G_TYPE_NONE, 3,
+		G_TYPE_ARRAY | G_SIGNAL_TYPE_STATIC_SCOPE, G_TYPE_INT64, G_TYPE_INT64
+	);
 }
 
 
 #include "SciLexer.h"
 #include "Lexilla.h"
 
+static int lineNumberWidth(GtkScintilla* self, int digits)
+{
+	// measured once per digit count until the font or zoom changes
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (priv->marginWidths[digits] == 0)
+	{
+		char buf[GSCI_MARGIN_DIGITS_MAX + 2] = "_";
+		memset(buf + 1, '9', digits);
+		buf[digits + 1] = '\0';
+		priv->marginWidths[digits] = SSM(self, SCI_TEXTWIDTH, STYLE_LINENUMBER, (sptr_t)buf);
+	}
+	return priv->marginWidths[digits];
+}
+
+void resetLineNumberWidths(GtkScintillaPrivate* priv)
+{
+	memset(priv->marginWidths, 0, sizeof(priv->marginWidths));
+	priv->marginDigits = 0;
+}
+
 void updateLineNumber(GtkScintilla* self)
 {
 	GtkScintillaPrivate* priv = PRIVATE(self);
 	if (priv->lineNumber)
 	{
-		int lines = SSM(self, SCI_GETLINECOUNT, 0, 0);
+		guint lines = SSM(self, SCI_GETLINECOUNT, 0, 0);
 		if (priv->lines != lines)
 		{
 			// notify lines
 			priv->lines = lines;
 			g_object_notify_by_pspec(G_OBJECT(self), props[PROP_LINES]);
+		}
 
-			// update line number margin width
-			char buf[16];
-			g_snprintf(buf, sizeof(buf), "_%d", lines);
-			int width = SSM(self, SCI_TEXTWIDTH, STYLE_LINENUMBER, (sptr_t)buf);
-			SSM(self, SCI_SETMARGINWIDTHN, 0, width);
+		// the margin width only changes with the number of digits
+		int digits = 1;
+		for (guint n = MAX(lines, priv->lineNumberMaxLines); n >= 10; n /= 10)
+			digits++;
+		if (priv->marginDigits != digits)
+		{
+			priv->marginDigits = digits;
+			SSM(self, SCI_SETMARGINWIDTHN, GSCI_NUMBER_MARGIN_INDEX, lineNumberWidth(self, digits));
 		}
 	}
 }
 
-static void configStyle(GtkScintillaPrivate* priv)
+static gboolean configLexer(GtkScintillaPrivate* priv)
 {
 	ScintillaObject* sci = priv->sci;
-	const ScintillaStyle* style = priv->style;
-	const ScintillaLanguage* lang = priv->lang;
-	gboolean dark = priv->dark;
+	const ScintillaLanguage* lang = priv->docState->lang;
 
-	// set lexer
+	// set lexer, releasing the old one returns it to the pool under its language
 	SSM(sci, SCI_SETILEXER, 0, 0);
-	if (lang->lexer)
+	if (!lang->lexer)
+		return FALSE;
+	void* lexer = scintilla_lexer_pool_take(lang->language);
+	gboolean prepared = lexer != NULL;
+	if (!prepared)
 	{
-		void* lexer = CreateLexer(lang->lexer);
+		lexer = CreateLexer(lang->lexer);
 		if (!lexer)
-			return;
-		SSM(sci, SCI_SETILEXER, 0, lexer);
+			return FALSE;
+		lexer = scintilla_lexer_pool_wrap(lang->language, lexer);
 	}
+	SSM(sci, SCI_SETILEXER, 0, lexer);
 
-	// set keywords
-	for (int i = 0; i < KEYWORDSET_MAX; i++)
+	// set keywords, a pooled lexer has already parsed them
+	for (int i = 0; i < KEYWORDSET_MAX && !prepared; i++)
 	{
 		SSM(sci, SCI_SETKEYWORDS, i, "");
 		if (lang->keywords)
 			SSM(sci, SCI_SETKEYWORDS, i, lang->keywords(i));
 	}
 
-	// set colors
-	guint32 defFgColor = SSM(sci, SCI_STYLEGETFORE, STYLE_DEFAULT, 0);
-	guint32 defBgColor = SSM(sci, SCI_STYLEGETBACK, STYLE_DEFAULT, 0);
+	// set lexer property
+	if (lang->setProps)
+		lang->setProps(sci);
+	return TRUE;
+}
+
+#define ELEMENT_MAX 81
+
+// Every style and element color of a theme, language and dark mode combination,
+// built on first use and kept for the process so switching back costs one bulk apply
+typedef struct _ScintillaStyleTable
+{
+	ScintillaStyleDef styles[STYLE_MAX];
+	ScintillaElementColour elements[ELEMENT_MAX];
+	int elementCount;
+} ScintillaStyleTable;
+
+static ScintillaStyleDef styleBase;
+static GHashTable* styleTables = NULL;
+
+void captureStyleBase(ScintillaObject* sci)
+{
+	// the default style of a fresh widget, the same for every widget
+	static gboolean captured = FALSE;
+	if (captured)
+		return;
+
+	styleBase.fore = SSM(sci, SCI_STYLEGETFORE, STYLE_DEFAULT, 0);
+	styleBase.back = SSM(sci, SCI_STYLEGETBACK, STYLE_DEFAULT, 0);
+	styleBase.size = SSM(sci, SCI_STYLEGETSIZE, STYLE_DEFAULT, 0);
+	styleBase.bold = SSM(sci, SCI_STYLEGETBOLD, STYLE_DEFAULT, 0);
+	styleBase.italic = SSM(sci, SCI_STYLEGETITALIC, STYLE_DEFAULT, 0);
+	styleBase.underline = SSM(sci, SCI_STYLEGETUNDERLINE, STYLE_DEFAULT, 0);
+	captured = TRUE;
+}
+
+static ScintillaStyleTable* buildStyleTable(const ScintillaStyle* style, const ScintillaLanguage* lang, gboolean dark)
+{
+	ScintillaStyleTable* table = g_new0(ScintillaStyleTable, 1);
+
+	guint32 defFgColor = styleBase.fore;
+	guint32 defBgColor = styleBase.back;
 	ScintillaFont defFont = { 0 };
-	defFont.size = SSM(sci, SCI_STYLEGETSIZE, STYLE_DEFAULT, 0);
-	defFont.bold = SSM(sci, SCI_STYLEGETBOLD, STYLE_DEFAULT, 0);
-	defFont.italic = SSM(sci, SCI_STYLEGETITALIC, STYLE_DEFAULT, 0);
-	defFont.underline = SSM(sci, SCI_STYLEGETUNDERLINE, STYLE_DEFAULT, 0);
-	if (priv->style)
-	{
-		priv->style->fgColor&& priv->style->fgColor(STYLE_DEFAULT, dark, &defFgColor);
-		priv->style->bgColor&& priv->style->bgColor(STYLE_DEFAULT, dark, &defBgColor);
-		priv->style->fonts&& priv->style->fonts(STYLE_DEFAULT, dark, &defFont);
-	}
+	defFont.size = styleBase.size;
+	defFont.bold = styleBase.bold;
+	defFont.italic = styleBase.italic;
+	defFont.underline = styleBase.underline;
+	style->fgColor&& style->fgColor(STYLE_DEFAULT, dark, &defFgColor);
+	style->bgColor&& style->bgColor(STYLE_DEFAULT, dark, &defBgColor);
+	style->fonts&& style->fonts(STYLE_DEFAULT, dark, &defFont);
 
 	for (int i = 0; i < STYLE_MAX; i++)
 	{
-		guint32 color = defFgColor;
-		style->fgColor&& style->fgColor(i, dark, &color);
-		lang->fgColor&& lang->fgColor(i, dark, &color);
-		SSM(sci, SCI_STYLESETFORE, i, color);
+		ScintillaStyleDef* def = &table->styles[i];
+
+		def->fore = defFgColor;
+		style->fgColor&& style->fgColor(i, dark, &def->fore);
+		lang->fgColor&& lang->fgColor(i, dark, &def->fore);
 
-		color = defBgColor;
-		style->bgColor&& style->bgColor(i, dark, &color);
-		lang->bgColor&& lang->bgColor(i, dark, &color);
-		SSM(sci, SCI_STYLESETBACK, i, color);
+		def->back = defBgColor;
+		style->bgColor&& style->bgColor(i, dark, &def->back);
+		lang->bgColor&& lang->bgColor(i, dark, &def->back);
 
 		ScintillaFont font = defFont;
 		style->fonts&& style->fonts(i, dark, &font);
 		lang->fonts&& lang->fonts(i, dark, &font);
-		font.name && SSM(sci, SCI_STYLESETFONT, i, font.name);
-		SSM(sci, SCI_STYLESETSIZE, i, font.size);
-		SSM(sci, SCI_STYLESETBOLD, i, font.bold);
-		SSM(sci, SCI_STYLESETITALIC, i, font.italic);
-		SSM(sci, SCI_STYLESETUNDERLINE, i, font.underline);
+		def->font = font.name;
+		def->size = font.size;
+		def->bold = font.bold;
+		def->italic = font.italic;
+		def->underline = font.underline;
 	}
 
-	// set element color
-#define ELEMENT_MAX 81
 	guint32 color = 0;
 	for (int i = 0; i < ELEMENT_MAX; i++)
 	{
 		if (style->elemColor && style->elemColor(i, dark, &color))
-			SSM(sci, SCI_SETELEMENTCOLOUR, i, color);
+		{
+			table->elements[table->elementCount].element = i;
+			table->elements[table->elementCount].colour = color;
+			table->elementCount++;
+		}
+	}
+	return table;
+}
+
+static const ScintillaStyleTable* styleTable(const ScintillaStyle* style, const ScintillaLanguage* lang, gboolean dark)
+{
+	if (!styleTables)
+		styleTables = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+	gsize key = ((style - GSCI_STYLES) * G_N_ELEMENTS(GSCI_LANGUAGES) + (lang - GSCI_LANGUAGES)) * 2 + (dark ? 1 : 0);
+	ScintillaStyleTable* table = g_hash_table_lookup(styleTables, GSIZE_TO_POINTER(key));
+	if (!table)
+	{
+		table = buildStyleTable(style, lang, dark);
+		g_hash_table_insert(styleTables, GSIZE_TO_POINTER(key), table);
 	}
+	return table;
+}
+
+static void configColors(GtkScintillaPrivate* priv)
+{
+	ScintillaObject* sci = priv->sci;
+	const ScintillaStyle* style = priv->style;
+	gboolean dark = priv->dark;
+
+	// set colors, fonts and element colors in one go
+	const ScintillaStyleTable* table = styleTable(style, priv->docState->lang, dark);
+	scintilla_object_apply_styles(sci, table->styles, STYLE_MAX, table->elements, table->elementCount);
+	resetLineNumberWidths(priv);
+	updateLineNumber(GTK_SCINTILLA(sci));
 
 	// set other property
 	if (style->setProps)
 		style->setProps(sci, dark);
-
-	if (lang->setProps)
-		lang->setProps(sci);
-	
 }
 
 static void configFold(ScintillaObject* sci, gboolean enb)
@@ -824,22 +3410,84 @@ static void configFold(ScintillaObject* sci, gboolean enb)
 	else
 	{
 		SSM(sci, SCI_SETMARGINWIDTHN, GSCI_FOLD_MARGIN_INDEX, 0);
+
+		// a pooled lexer may still fold for its previous document
+		SSM(sci, SCI_SETPROPERTY, "fold", "0");
+		SSM(sci, SCI_SETPROPERTY, "fold.html", "0");
 	}
 }
 
 void updateStyle(GtkScintillaPrivate* priv)
 {
-	// reset
-	SSM(priv->sci, SCI_CLEARDOCUMENTSTYLE, 0, 0);
-	
-	// set style
-	configStyle(priv);
+	// colors and fonts only, the lexed styles stay valid
+	configColors(priv);
+}
+
+static gboolean restyleIdle(GtkScintilla* self)
+{
+	// only these styling modes carry on past the visible lines without painting
+	int idle = SSM(self, SCI_GETIDLESTYLING, 0, 0);
+	return idle == SC_IDLESTYLING_AFTERVISIBLE || idle == SC_IDLESTYLING_ALL;
+}
+
+static gboolean restyleTick(gpointer p)
+{
+	GtkScintilla* self = p;
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_RESTYLE_PROGRESS]);
+
+	// styling may also stall unmapped or without idle styling, painting or editing restarts the timer
+	gintptr endStyled = SSM(self, SCI_GETENDSTYLED, 0, 0);
+	gboolean progress = endStyled != priv->restyleEnd;
+	priv->restyleEnd = endStyled;
+	if (gtk_scintilla_get_restyle_progress(self) < 1.0 && progress && restyleIdle(self))
+		return G_SOURCE_CONTINUE;
+
+	priv->restyleTimer = 0;
+	return G_SOURCE_REMOVE;
+}
+
+void restyleStart(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (!priv->lexer || priv->restyleTimer || gtk_scintilla_get_restyle_progress(self) >= 1.0)
+		return;
+	priv->restyleEnd = SSM(self, SCI_GETENDSTYLED, 0, 0);
+	priv->restyleTimer = g_timeout_add(GSCI_RESTYLE_INTERVAL, restyleTick, self);
+}
+
+void updateLexer(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
 
-	// fold
+	// drop the old styles and fold levels but lex nothing here: painting lexes up to the visible lines
+	// within a time bound and idle styling finishes the rest of the document in slices
+	SSM(self, SCI_CLEARDOCUMENTSTYLE, 0, 0);
+	priv->lexer = configLexer(priv);
+	configColors(priv);
 	configFold(priv->sci, priv->fold);
+	SSM(self, SCI_STARTSTYLING, 0, 0);
 
-	// update color
-	SSM(priv->sci, SCI_COLOURISE, 0, -1);
+	g_object_notify_by_pspec(G_OBJECT(self), props[PROP_RESTYLE_PROGRESS]);
+	restyleStart(self);
+}
+
+// the lexer is set once through self, the other views showing the document take the colours of the language
+void updateDocumentLexer(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	updateLexer(self);
+	for (guint i = 0; i < priv->docState->views->len; i++)
+	{
+		GtkScintilla* view = g_ptr_array_index(priv->docState->views, i);
+		if (view == self)
+			continue;
+		GtkScintillaPrivate* other = PRIVATE(view);
+		other->lexer = priv->lexer;
+		configColors(other);
+		g_object_notify_by_pspec(G_OBJECT(view), props[PROP_RESTYLE_PROGRESS]);
+		restyleStart(view);
+	}
 }
 
 void updateFold(GtkScintillaPrivate* priv)
@@ -847,6 +3495,41 @@ void updateFold(GtkScintillaPrivate* priv)
 	configFold(priv->sci, priv->fold);
 }
 
+void setReadOnly(GtkScintillaPrivate* priv, gboolean readOnly)
+{
+	SSM(priv->sci, SCI_SETREADONLY, readOnly, 0);
+}
+
+void attachDocument(GtkScintilla* self, gpointer doc)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+
+	// eol mode and tab width are stored in the document
+	int eolMode = SSM(self, SCI_GETEOLMODE, 0, 0);
+	int tabWidth = SSM(self, SCI_GETTABWIDTH, 0, 0);
+
+	changesDrop(self); // spans of the old document
+	SSM(self, SCI_SETDOCPOINTER, 0, doc);
+	SSM(self, SCI_RELEASEDOCUMENT, 0, doc); // view holds the only reference
+	docStateJoin(self, doc);
+
+	SSM(self, SCI_SETEOLMODE, eolMode, 0);
+	SSM(self, SCI_SETTABWIDTH, tabWidth, 0);
+	setReadOnly(priv, !priv->docState->editable);
+	if (priv->logMode)
+		logConfigHistory(self); // undo collection is stored in the document
+	updateSearchIndex(self);
+	termRestart(self);
+	for (guint i = 0; i < priv->searches->len; i++)
+		sessionRestart(g_ptr_array_index(priv->searches, i));
+
+	// lexer is stored in the document
+	updateLexer(self);
+	updateLineNumber(self);
+	tune(self);
+	g_signal_emit(self, signals[SIGNAL_TEXT_CHANGED], 0);
+}
+
 static void lineIndent(GtkScintilla* self)
 {
 	int pos = SSM(self, SCI_GETSELECTIONSTART, 0, 0);
@@ -870,6 +3553,145 @@ static void lineIndent(GtkScintilla* self)
 	}
 }
 
+// change notifications
+
+// one coalesced edit: inserted bytes replaced deleted bytes at position, spans apply in order
+typedef struct _GtkScintillaChange
+{
+	gintptr position;
+	gintptr inserted;
+	gintptr deleted;
+} GtkScintillaChange;
+
+static gboolean changesMerge(GtkScintillaChange* last, int mod, gintptr pos, gintptr length)
+{
+	gintptr lastEnd = last->position + last->inserted;
+	if (mod & SC_MOD_INSERTTEXT)
+	{
+		// typing on inside or at the end of the span
+		if (pos < last->position || pos > lastEnd)
+			return FALSE;
+		last->inserted += length;
+		return TRUE;
+	}
+	if (pos >= last->position && pos + length <= lastEnd)
+		last->inserted -= length; // removing inserted text
+	else if (pos == lastEnd)
+		last->deleted += length; // deleting forward
+	else if (pos + length == last->position)
+	{
+		// deleting backward
+		last->position = pos;
+		last->deleted += length;
+	}
+	else
+		return FALSE;
+	return TRUE;
+}
+
+// runs on the frame clock before the frame is laid out and painted so handlers can update what is drawn
+static gboolean changesTickCallback(GtkWidget* widget, GdkFrameClock* clock, gpointer data)
+{
+	GtkScintillaPrivate* priv = PRIVATE(GTK_SCINTILLA(widget));
+	priv->changesTick = 0;
+	changesFlush(GTK_SCINTILLA(widget));
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean changesTimeout(gpointer p)
+{
+	GtkScintillaPrivate* priv = PRIVATE(GTK_SCINTILLA(p));
+	priv->changesTimer = 0;
+	changesFlush(p);
+	return G_SOURCE_REMOVE;
+}
+
+void changesSchedule(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (priv->changesTick || priv->changesTimer)
+		return;
+
+	// once per frame, hidden widgets do not tick so they use a timer instead
+	if (gtk_widget_get_mapped(GTK_WIDGET(self)))
+		priv->changesTick = gtk_widget_add_tick_callback(GTK_WIDGET(self), changesTickCallback, NULL, NULL);
+	else
+		priv->changesTimer = g_timeout_add(GSCI_CHANGES_INTERVAL, changesTimeout, self);
+}
+
+static void changesCancel(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	if (priv->changesTick)
+	{
+		gtk_widget_remove_tick_callback(GTK_WIDGET(self), priv->changesTick);
+		priv->changesTick = 0;
+	}
+	if (priv->changesTimer)
+	{
+		g_source_remove(priv->changesTimer);
+		priv->changesTimer = 0;
+	}
+}
+
+void changesAdd(GtkScintilla* self, int mod, gintptr pos, gintptr length, gintptr linesAdded)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	gint64 line = SSM(self, SCI_LINEFROMPOSITION, pos, 0);
+	if (!priv->changes || priv->changes->len == 0)
+	{
+		if (!priv->changes)
+			priv->changes = g_array_new(FALSE, FALSE, sizeof(GtkScintillaChange));
+		priv->changeFirstLine = line;
+		priv->changeLastLine = line;
+	}
+
+	guint len = priv->changes->len;
+	if (len == 0 || !changesMerge(&g_array_index(priv->changes, GtkScintillaChange, len - 1), mod, pos, length))
+	{
+		GtkScintillaChange change = { pos, 0, 0 };
+		if (mod & SC_MOD_INSERTTEXT)
+			change.inserted = length;
+		else
+			change.deleted = length;
+		g_array_append_val(priv->changes, change);
+	}
+
+	// lines in the current text, those after the edit moved with it
+	if (linesAdded > 0 && priv->changeLastLine > line)
+		priv->changeLastLine += linesAdded;
+	else if (linesAdded < 0 && priv->changeLastLine > line)
+		priv->changeLastLine = MAX(priv->changeLastLine + linesAdded, line);
+	priv->changeFirstLine = MIN(priv->changeFirstLine, line);
+	priv->changeLastLine = MAX(priv->changeLastLine, line + MAX(linesAdded, 0));
+
+	changesSchedule(self);
+}
+
+void changesFlush(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	changesCancel(self);
+	if (!priv->changes || priv->changes->len == 0)
+		return;
+
+	// handlers may edit again which starts the next batch
+	GArray* changes = g_steal_pointer(&priv->changes);
+	updateLineNumber(self);
+	// wrap mode and document changes tune at once, edits only once the length crosses a power of two
+	if (g_bit_storage(SSM(self, SCI_GETLENGTH, 0, 0)) != priv->tuneBucket)
+		tune(self);
+	g_signal_emit(self, signals[SIGNAL_CHANGES], 0, changes, priv->changeFirstLine, priv->changeLastLine);
+	g_array_unref(changes);
+}
+
+void changesDrop(GtkScintilla* self)
+{
+	GtkScintillaPrivate* priv = PRIVATE(self);
+	changesCancel(self);
+	g_clear_pointer(&priv->changes, g_array_unref);
+}
+
 void onSciNotify(GtkScintilla* self, gint param, SCNotification* notif, GtkScintillaPrivate* priv)
 {
 	switch (notif->nmhdr.code)
@@ -879,14 +3701,30 @@ void onSciNotify(GtkScintilla* self, gint param, SCNotification* notif, GtkScint
 		int mod = notif->modificationType;
 		if (mod & SC_MOD_INSERTTEXT || mod & SC_MOD_DELETETEXT)
 		{
-			updateLineNumber(self);
+			termEdited(self, mod, notif->position, notif->length);
+			for (guint i = 0; i < priv->searches->len; i++)
+				sessionEdited(g_ptr_array_index(priv->searches, i), mod, notif->position, notif->length);
+			changesAdd(self, mod, notif->position, notif->length, notif->linesAdded);
+			restyleStart(self);
 			g_signal_emit(self, signals[SIGNAL_TEXT_CHANGED], 0);
+
+			// an undo or redo group is reported as soon as it is complete
+			if (mod & SC_LASTSTEPINUNDOREDO)
+				changesFlush(self);
 		}
 		break;
 	}
+	case SCN_ZOOM:
+		resetLineNumberWidths(priv);
+		updateLineNumber(self);
+		break;
 	case SCN_UPDATEUI:
 		//printf("sci-notify update ui\n");
 		break;
+	case SCN_PAINTED:
+		// painting styles the visible lines and starts idle styling again
+		restyleStart(self);
+		break;
 	case SCN_CHARADDED:
 	{
 		if (notif->ch == '\n')